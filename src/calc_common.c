@@ -0,0 +1,299 @@
+/** @file calc_common.c
+ *  @brief The code shared by the calculator number types.
+ *  @author Wojciech 'vifon' Siewierski
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#include "calc_common.h"
+
+#include "wide_int.h"
+
+/** All the two-digit decimal numbers, used to convert two digits at
+ *  a time. */
+static const char s_digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/** Divide a 32-bit number by 100 and also calculate the remainder.
+ *
+ *  @param n
+ *  @param[out] remainder <tt>n % 100</tt>
+ *
+ *  @return <tt>n / 100</tt>
+ */
+static inline uint32_t divmod100_u32(uint32_t n, uint32_t* remainder)
+{
+    /* 0x51EB851F == ceil(2^37 / 100), exact for the whole 32-bit range. */
+    uint32_t quotient = (uint32_t)(((uint64_t)n * 0x51EB851FU) >> 37);
+    *remainder = n - quotient * 100;
+    return quotient;
+}
+
+/** Divide a 64-bit number by 100 with a multiplication by its
+ *  reciprocal, as the ARM CPUs have no 64-bit divide.
+ *
+ *  @param n
+ *
+ *  @return <tt>n / 100</tt>
+ */
+static inline uint64_t div100_u64(uint64_t n)
+{
+    /* 100 == 4 * 25 and 0x28F5C28F5C28F5C3 == ceil(2^66 / 100),
+     * exact for the whole 64-bit range after the pre-shift. */
+    return wide_umulh64(n >> 2, 0x28F5C28F5C28F5C3ULL) >> 2;
+}
+
+/** Count the decimal digits of a number.
+ *
+ *  @param n
+ *
+ *  @return The number of digits, at least 1.
+ */
+size_t calc_count_digits(uint64_t n)
+{
+    static const uint32_t powers_of_10[] = {
+        10, 100, 1000, 10000, 100000,
+        1000000, 10000000, 100000000, 1000000000,
+    };
+
+    /* Only the 64-bit numbers need the 64-bit comparisons. */
+    size_t digits = 1;
+    while (n > UINT32_MAX) {
+        n = div100_u64(n);
+        digits += 2;
+    }
+
+    uint32_t small = (uint32_t)n;
+    size_t small_digits = 1;
+    while (small_digits < 10 && small >= powers_of_10[small_digits-1]) {
+        ++small_digits;
+    }
+    return digits - 1 + small_digits;
+}
+
+/** Write the decimal digits of a number backwards, ending at @p end.
+ *
+ *  @param end One past the last written character.
+ *  @param n The number to write.
+ *  @param count The number of digits to write. The number is padded
+ *  with leading zeros if it has fewer.
+ *
+ *  @return The first written character.
+ */
+char* calc_write_digits_backwards(char* end, uint64_t n, size_t count)
+{
+    uint32_t last_digits;
+
+    /* Use the 64-bit division only while the 32-bit one won't do. */
+    for (; n > UINT32_MAX; count -= 2) {
+        uint64_t quotient = div100_u64(n);
+        last_digits = (uint32_t)(n - quotient * 100);
+        n = quotient;
+        end -= 2;
+        end[0] = s_digit_pairs[last_digits * 2];
+        end[1] = s_digit_pairs[last_digits * 2 + 1];
+    }
+
+    uint32_t small = (uint32_t)n;
+    for (; count >= 2; count -= 2) {
+        small = divmod100_u32(small, &last_digits);
+        end -= 2;
+        end[0] = s_digit_pairs[last_digits * 2];
+        end[1] = s_digit_pairs[last_digits * 2 + 1];
+    }
+    if (count != 0) {
+        *--end = '0' + small;
+    }
+
+    return end;
+}
+
+/** A positive number <tt>mantissa * 2^exponent</tt> with 64
+ *  significant bits, the top bit of the mantissa is always set. */
+typedef struct {
+    uint64_t mantissa;
+    int64_t exponent;
+} WideFloat;
+
+/** Convert a positive integer to @ref WideFloat exactly.
+ *
+ *  @param n Not 0.
+ *
+ *  @return @p n
+ */
+static WideFloat wide_float(uint64_t n)
+{
+    WideFloat result = {n, 0};
+    while (!(result.mantissa >> 63)) {
+        result.mantissa <<= 1;
+        --result.exponent;
+    }
+    return result;
+}
+
+/** Multiply two @ref WideFloat numbers, rounding down.
+ *
+ *  @param lhs
+ *  @param rhs
+ *
+ *  @return <tt>lhs * rhs</tt>
+ */
+static WideFloat wide_float_mult(WideFloat lhs, WideFloat rhs)
+{
+    WideFloat result;
+    uint64_t lo = wide_mul_u64(lhs.mantissa, rhs.mantissa, &result.mantissa);
+    result.exponent = lhs.exponent + rhs.exponent + 64;
+
+    /* The product of the mantissas is at least 2^126. */
+    if (!(result.mantissa >> 63)) {
+        result.mantissa = (result.mantissa << 1) | (lo >> 63);
+        --result.exponent;
+    }
+    return result;
+}
+
+/** Divide two @ref WideFloat numbers, rounding down.
+ *
+ *  @param lhs
+ *  @param rhs
+ *
+ *  @return <tt>lhs / rhs</tt>
+ */
+static WideFloat wide_float_div(WideFloat lhs, WideFloat rhs)
+{
+    /* lhs.mantissa * 2^63 / rhs.mantissa is at least 2^62 and the
+     * high half of the dividend is less than the divisor. */
+    WideFloat result;
+    result.mantissa = wide_div_u64(lhs.mantissa >> 1, lhs.mantissa << 63, rhs.mantissa);
+    result.exponent = lhs.exponent - rhs.exponent - 63;
+
+    if (!(result.mantissa >> 63)) {
+        result.mantissa <<= 1;
+        --result.exponent;
+    }
+    return result;
+}
+
+/** The greatest common divisor of two numbers.
+ *
+ *  @param a
+ *  @param b
+ *
+ *  @return <tt>gcd(a, b)</tt>
+ */
+static uint64_t greatest_common_divisor(uint64_t a, uint64_t b)
+{
+    while (b != 0) {
+        uint64_t remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+    return a;
+}
+
+/** Raise a @ref WideFloat number to a power by squaring.
+ *
+ *  @param base
+ *  @param n
+ *
+ *  @return <tt>base^n</tt>, exact if it fits in the 64 significant
+ *  bits.
+ */
+static WideFloat wide_float_pow(WideFloat base, unsigned int n)
+{
+    WideFloat result = wide_float(1);
+
+    /* At most 32 squarings, so the exponents stay far from overflowing. */
+    for (;;) {
+        if (n & 1) {
+            result = wide_float_mult(result, base);
+        }
+
+        n >>= 1;
+        if (n == 0) {
+            break;
+        }
+
+        base = wide_float_mult(base, base);
+    }
+    return result;
+}
+
+/** Raise the reciprocal of a fixed point number to a power.
+ *
+ *  Computes <tt>one * (one / magnitude)^n</tt> as a reduced fraction
+ *  with a single division at the end, keeping the 64 significant bits
+ *  at every step. The result is exact if the powers of the numerator
+ *  and the denominator fit in them, which includes every result that
+ *  is a whole multiple of the fixed point unit. Otherwise it is off
+ *  by a relative error below <tt>n * 2^-61</tt>.
+ *
+ *  @param one The representation of 1 of the fixed point type.
+ *  @param magnitude The representation of the absolute value of the
+ *  number.
+ *  @param n The power.
+ *  @param max The largest representable number.
+ *  @param[out] overflow Set if the result would be greater than @p
+ *  max or @p magnitude is 0. Left intact otherwise.
+ *
+ *  @return The representation of the result, rounded toward 0 when
+ *  exact. Unspecified if an overflow occurred.
+ */
+uint64_t calc_reciprocal_power(uint64_t one, uint64_t magnitude, unsigned int n,
+                               uint64_t max, bool* overflow)
+{
+    if (magnitude == 0) {
+        *overflow = true;
+        return 0;
+    }
+
+    /* Reduced, the powers fit in the significant bits whenever the
+     * result is a whole multiple of the fixed point unit. */
+    uint64_t divisor = greatest_common_divisor(one, magnitude);
+
+    WideFloat numerator = wide_float_mult(
+        wide_float_pow(wide_float(one / divisor), n),
+        wide_float(one));
+    WideFloat denominator = wide_float_pow(wide_float(magnitude / divisor), n);
+    WideFloat result = wide_float_div(numerator, denominator);
+
+    /* Any number with a non-negative exponent is at least 2^63. */
+    if (result.exponent >= 0) {
+        *overflow = true;
+        return 0;
+    } else if (result.exponent <= -64) {
+        return 0;
+    }
+
+    uint64_t integer = result.mantissa >> -result.exponent;
+    if (integer > max) {
+        *overflow = true;
+    }
+    return integer;
+}
@@ -0,0 +1,106 @@
+/** @file calc_common.h
+ *  @brief The code shared by the calculator number types.
+ *  @author Wojciech 'vifon' Siewierski
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#ifndef _h_CALC_COMMON_
+#define _h_CALC_COMMON_
+
+#include "config.h"
+
+/* Do not include pebble.h when compiling the unittests. */
+#ifndef __cplusplus
+#   include <pebble.h>             /* for bool */
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+size_t calc_count_digits(uint64_t n);
+char* calc_write_digits_backwards(char* end, uint64_t n, size_t count);
+uint64_t calc_reciprocal_power(uint64_t one, uint64_t magnitude, unsigned int n,
+                               uint64_t max, bool* overflow);
+
+/** Define the <tt>pow(3)</tt> standard function for a fixed point
+ *  type using exponentiation by squaring, named and calling the
+ *  other operators the same way as @ref CREATE_OPERATOR_FOR_TYPE.
+ *
+ *  The negative powers are computed with @ref calc_reciprocal_power.
+ *  Raising the number first and dividing afterwards would round the
+ *  powers of the numbers below 1 down to 0.
+ *
+ *  @param TYPE The fixed point type with the @p mult operator.
+ *  @param ONE The representation of 1.
+ *  @param MAX The largest representable number.
+ */
+#define DEFINE_POW(TYPE, ONE, MAX)                                      \
+    TYPE CREATE_OPERATOR_FOR_TYPE(TYPE, pow)(TYPE base, int exponent, bool* overflow) \
+    {                                                                   \
+        bool negative = exponent < 0;                                   \
+        /* Negated as unsigned to handle INT_MIN too. */                \
+        unsigned int n = negative                                       \
+            ? 0u - (unsigned int)exponent                               \
+            : (unsigned int)exponent;                                   \
+                                                                        \
+        /* The powers of 0, 1 and -1 are known without any multiplication. */ \
+        if (n == 0 || base == (ONE)) {                                  \
+            return (ONE);                                               \
+        } else if (base == -(ONE)) {                                    \
+            return (n & 1) ? -(ONE) : (ONE);                            \
+        } else if (base == 0 && !negative) {                            \
+            return 0;                                                   \
+        }                                                               \
+                                                                        \
+        if (negative) {                                                 \
+            uint64_t magnitude = base < 0 ? 0 - (uint64_t)base : (uint64_t)base; \
+            TYPE result = (TYPE)calc_reciprocal_power(                  \
+                (ONE), magnitude, n, (MAX), overflow);                  \
+            return (base < 0 && (n & 1)) ? -result : result;            \
+        }                                                               \
+                                                                        \
+        bool too_big = false;                                           \
+        TYPE result = (ONE);                                            \
+                                                                        \
+        for (;;) {                                                      \
+            if (n & 1) {                                                \
+                result = CREATE_OPERATOR_FOR_TYPE(TYPE, mult)(result, base, &too_big); \
+            }                                                           \
+                                                                        \
+            n >>= 1;                                                    \
+            if (n == 0 || too_big || result == 0) {                     \
+                break;                                                  \
+            }                                                           \
+                                                                        \
+            /* Each following factor is at least this square, so if it \
+             * is too big or 0, so will be the result. */               \
+            base = CREATE_OPERATOR_FOR_TYPE(TYPE, mult)(base, base, &too_big); \
+            if (base == 0) {                                            \
+                result = 0;                                             \
+                break;                                                  \
+            }                                                           \
+        }                                                               \
+                                                                        \
+        *overflow = *overflow || too_big;                               \
+        return result;                                                  \
+    }
+
+#endif
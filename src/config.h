@@ -9,10 +9,66 @@
 
 
 
+/** Use the 64-bit fixed point numbers with 6 decimal places
+ *  (fixed64) instead of the 32-bit ones with 2 decimal places (fixed).
+ */
+#define ENABLE_FIXED64 0
+
+
+
+/** Use the binary 32-bit fixed point numbers (qfixed) instead of the
+ *  decimal ones (fixed). Their multiplication and division rescale
+ *  with shifts instead of dividing by a power of 10, but the range
+ *  is narrower. Ignored if @ref ENABLE_FIXED64 is set.
+ */
+#define ENABLE_QFIXED 0
+
+
+
+/** Number of the fractional bits of the binary fixed point numbers
+ *  (qfixed), either 16 (Q16.16, 4 decimal places, up to 32767) or 12
+ *  (Q20.12, 3 decimal places, up to 524287).
+ */
+#ifndef QFIXED_FRACTIONAL_BITS
+#   define QFIXED_FRACTIONAL_BITS 16
+#endif
+
+
+
+/** Number of the decimal places of the 32-bit fixed point numbers
+ *  (fixed), from 1 to 4. More of them narrow the range of the
+ *  integral part. Can be also set from the command line, as
+ *  <tt>-DFIXED_FRACTIONAL_DIGITS=3</tt>.
+ */
+#ifndef FIXED_FRACTIONAL_DIGITS
+#   define FIXED_FRACTIONAL_DIGITS 2
+#endif
+
+
+
+/** Build the elementary functions of the 32-bit fixed point numbers
+ *  (fixed_sqrt(), fixed_exp(), fixed_ln(), fixed_sin(), fixed_cos()
+ *  and fixed_atan()). No key uses them yet, they are library-only
+ *  groundwork for the scientific functions, so the watch build
+ *  leaves them out. The unittests set it from the command line, as
+ *  <tt>-DENABLE_ELEMENTARY_FUNCTIONS=1</tt>.
+ */
+#ifndef ENABLE_ELEMENTARY_FUNCTIONS
+#   define ENABLE_ELEMENTARY_FUNCTIONS 0
+#endif
+
+
+
 /** Size of the calculator stack (@ref s_calculator_stack). */
 #define CALC_STACK_SIZE 64
 /** Numeric type used for the calculations. */
-#define CALC_TYPE fixed
+#if ENABLE_FIXED64
+#   define CALC_TYPE fixed64
+#elif ENABLE_QFIXED
+#   define CALC_TYPE qfixed
+#else
+#   define CALC_TYPE fixed
+#endif
 /** @p printf format specifier for @p REPR(CALC_TYPE). */
 #define CALC_TYPE_FMT "%s"
 
@@ -38,7 +94,11 @@
  *  - mult,
  *  - div,
  *  - pow,
- *  - repr.
+ *  - repr,
+ *  - to_str,
+ *  - append_digit,
+ *  - remove_digit,
+ *  - to_int.
  */
 #define CREATE_OPERATOR(OP) CREATE_OPERATOR_FOR_TYPE(CALC_TYPE, OP)
 
@@ -48,14 +108,64 @@
 #define DIV CREATE_OPERATOR(div)
 #define POW CREATE_OPERATOR(pow)
 #define REPR CREATE_OPERATOR(repr)
+#define TO_STR CREATE_OPERATOR(to_str)
+#define APPEND_DIGIT CREATE_OPERATOR(append_digit)
+#define REMOVE_DIGIT CREATE_OPERATOR(remove_digit)
+#define TO_INT CREATE_OPERATOR(to_int)
 
 
 
 /** Size of the input buffer (@ref s_input_buffer). */
 #define INPUT_BUFFER_SIZE 32
 
-/** The number of samples used for the calibration at the startup */
-#define CALIBRATION_SAMPLES 10
+/** The strength of the accelerometer calibration. The balance point
+ *  starts at the mean of the first batch and then every still batch
+ *  with the cursor resting on a button moves it by 2^-shift of the
+ *  distance to the mean of that batch, following the wrist drift.
+ */
+#define CALIBRATION_SHIFT 4
+
+/** The accelerometer sampling rate, one of the AccelSamplingRate
+ *  values. The cursor speed does not depend on it. */
+#define ACCEL_SAMPLING_RATE ACCEL_SAMPLING_50HZ
+
+/** The number of the accelerometer samples delivered at once. The
+ *  cursor is moved and redrawn once per batch, so the app wakes up
+ *  ACCEL_SAMPLING_RATE / ACCEL_BATCH_SIZE times per second. 1 with
+ *  ACCEL_SAMPLING_25HZ and ACCEL_FILTER_SHIFT 0 gives the old
+ *  sample-by-sample behavior.
+ */
+#define ACCEL_BATCH_SIZE 5
+
+/** The accelerometer sampling rate and the batch size used while the
+ *  cursor rests on a button and the watch is held still. Both the
+ *  rate goes down and the batch gets longer, so the app wakes up once
+ *  per second. The first motion is noticed at the end of a batch, so
+ *  the batch should not last much longer.
+ */
+#define ACCEL_REST_SAMPLING_RATE ACCEL_SAMPLING_10HZ
+/** @copydoc ACCEL_REST_SAMPLING_RATE */
+#define ACCEL_REST_BATCH_SIZE 10
+
+/** The motion energy, the mean change of the accelerometer reading
+ *  between the consecutive samples in mG, below which the watch is
+ *  considered still. */
+#define MOTION_REST_THRESHOLD 24
+
+/** The motion energy above which the resting sampling rate is left
+ *  immediately. Higher than @ref MOTION_REST_THRESHOLD, so the noise
+ *  around a single threshold cannot switch the rate back and forth. */
+#define MOTION_WAKE_THRESHOLD 48
+
+/** The number of the consecutive still batches after which the
+ *  sampling rate is lowered. */
+#define MOTION_REST_BATCHES 20
+
+/** The strength of the low-pass filter of the accelerometer
+ *  samples. Each sample moves the filtered tilt by 2^-shift of the
+ *  difference, 0 disables the filter.
+ */
+#define ACCEL_FILTER_SHIFT 1
 
 /** The factor of steepness of each button.
  *
@@ -0,0 +1,267 @@
+/** @file cursor.c
+ *  @brief The integer-only cursor motion engine.
+ *  @author Wojciech 'vifon' Siewierski
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#include "cursor.h"
+
+#include <stdlib.h>
+
+/** Move the balance point toward the mean of a batch, an exponential
+ *  moving average of the batches.
+ *
+ *  @param calibration
+ *  @param sum_x The sum of the raw accelerometer readings in mG.
+ *  @param sum_y @copydoc sum_x
+ *  @param samples The number of the summed readings, not 0.
+ *  @param shift The balance point moves by 2^-shift of the distance.
+ *  Ignored for the first batch, which sets it directly.
+ */
+void cursor_calibration_update(CursorCalibration* calibration,
+                               int32_t sum_x, int32_t sum_y, uint32_t samples,
+                               int shift)
+{
+    const int32_t mean_x = CURSOR_TILT(sum_x) / (int32_t)samples;
+    const int32_t mean_y = CURSOR_TILT(sum_y) / (int32_t)samples;
+
+    if (!calibration->calibrated) {
+        calibration->calibrated = true;
+        calibration->zero_x = mean_x;
+        calibration->zero_y = mean_y;
+    } else {
+        calibration->zero_x += (mean_x - calibration->zero_x) >> shift;
+        calibration->zero_y += (mean_y - calibration->zero_y) >> shift;
+    }
+}
+
+/** Add a sample to the motion energy of the current batch.
+ *
+ *  @param activity
+ *  @param x The raw accelerometer reading in mG.
+ *  @param y @copydoc x
+ */
+void cursor_activity_add(CursorActivity* activity, int x, int y)
+{
+    if (activity->primed) {
+        activity->energy += abs(x - activity->last_x) + abs(y - activity->last_y);
+        ++activity->samples;
+    }
+    activity->primed = true;
+    activity->last_x = x;
+    activity->last_y = y;
+}
+
+/** Finish the batch and decide the sampling rate for the next ones.
+ *
+ *  The resting rate is entered only after @ref MOTION_REST_BATCHES
+ *  still batches with the cursor on a button, and left as soon as a
+ *  single batch moves more than @ref MOTION_WAKE_THRESHOLD or the
+ *  cursor leaves the button.
+ *
+ *  @param activity
+ *  @param on_button Whether the cursor rests on a button.
+ *
+ *  @return True if the sampling rate should change.
+ */
+bool cursor_activity_update(CursorActivity* activity, bool on_button)
+{
+    /* The mean change per sample, without dividing. */
+    const uint32_t samples = activity->samples > 0 ? activity->samples : 1;
+    const bool still = activity->energy < MOTION_REST_THRESHOLD * samples;
+    const bool moving = activity->energy > MOTION_WAKE_THRESHOLD * samples;
+
+    if (activity->resting) {
+        ++activity->resting_batches;
+        activity->resting_samples += activity->samples;
+    } else {
+        ++activity->active_batches;
+        activity->active_samples += activity->samples;
+    }
+    activity->energy = 0;
+    activity->samples = 0;
+
+    if (still && on_button) {
+        ++activity->still_batches;
+    } else {
+        activity->still_batches = 0;
+    }
+
+    bool resting = activity->resting;
+    if (resting && (moving || !on_button)) {
+        resting = false;
+    } else if (!resting && activity->still_batches >= MOTION_REST_BATCHES) {
+        resting = true;
+    }
+
+    if (resting == activity->resting) {
+        return false;
+    }
+    activity->resting = resting;
+    activity->still_batches = 0;
+    ++activity->switches;
+    return true;
+}
+
+/** The number of the samples per batch for the current sampling rate.
+ *
+ *  @param activity
+ *
+ *  @return @ref ACCEL_REST_BATCH_SIZE while resting, @ref
+ *  ACCEL_BATCH_SIZE otherwise.
+ */
+uint32_t cursor_activity_batch_size(const CursorActivity* activity)
+{
+    return activity->resting ? ACCEL_REST_BATCH_SIZE : ACCEL_BATCH_SIZE;
+}
+
+/** Pass a sample through the low-pass filter and add it to the
+ *  current batch.
+ *
+ *  @param filter
+ *  @param tilt The accelerometer reading relative to its balance
+ *  point, see @ref CURSOR_TILT.
+ *  @param shift The filter strength, the filtered tilt moves by
+ *  2^-shift of its distance to @p tilt. 0 disables the filter.
+ */
+void cursor_filter_add(CursorFilter* filter, int32_t tilt, int shift)
+{
+    filter->tilt += (tilt - filter->tilt) >> shift;
+    filter->sum += filter->tilt;
+}
+
+/** Take the filtered tilt of the current batch and start a new one.
+ *
+ *  @param filter
+ *  @param rate The sampling rate in Hz.
+ *
+ *  @return The sum of the filtered samples rescaled to @ref
+ *  CURSOR_REFERENCE_RATE, see @ref CURSOR_TILT. With it the cursor
+ *  moves as far as it would with one sample per reference period, no
+ *  matter the rate and the batch size.
+ */
+int32_t cursor_filter_take(CursorFilter* filter, int rate)
+{
+    int32_t sum = filter->sum;
+    filter->sum = 0;
+
+    if (rate == CURSOR_REFERENCE_RATE) {
+        return sum;
+    }
+    return (int32_t)((int64_t)sum * CURSOR_REFERENCE_RATE / rate);
+}
+
+/** Rescale the button steepness to a batch.
+ *
+ *  The pull of the focused button is defined per sample at @ref
+ *  CURSOR_REFERENCE_RATE, but it is applied once per batch.
+ *
+ *  @param steepness The steepness at the reference rate.
+ *  @param samples The number of the samples in the batch.
+ *  @param rate The sampling rate in Hz.
+ *
+ *  @return The steepness for @ref cursor_axis_pull, at least 1 so the
+ *  pull never overshoots.
+ */
+int cursor_batch_steepness(int steepness, int samples, int rate)
+{
+    int batch_steepness = steepness * rate / (samples * CURSOR_REFERENCE_RATE);
+    return batch_steepness > 1 ? batch_steepness : 1;
+}
+
+/** Place the cursor at the given pixel and stop it.
+ *
+ *  @param axis
+ *  @param pixel
+ */
+void cursor_axis_set(CursorAxis* axis, int pixel)
+{
+    axis->position = (int32_t)pixel << CURSOR_SUBPIXEL_BITS;
+    axis->velocity = 0;
+}
+
+/** Get the pixel the cursor is drawn at and hit-tests with.
+ *
+ *  @param axis
+ *
+ *  @return The position rounded down to the whole pixels.
+ */
+int cursor_axis_pixel(const CursorAxis* axis)
+{
+    return axis->position >> CURSOR_SUBPIXEL_BITS;
+}
+
+/** Calculate the pull toward the target, such as the center of the
+ *  focused button which is concave.
+ *
+ *  @param axis
+ *  @param target The pixel the cursor is pulled to.
+ *  @param steepness The pull is the distance divided by it.
+ *
+ *  @return The pull in the cursor coordinates.
+ */
+int32_t cursor_axis_pull(const CursorAxis* axis, int target, int steepness)
+{
+    return (((int32_t)target << CURSOR_SUBPIXEL_BITS) - axis->position) / steepness;
+}
+
+/** Convert the tilt to the cursor movement.
+ *
+ *  The Pebble CPUs have no FPU, so instead of multiplying by the
+ *  floating point ratio of the screen size and @ref CURSOR_ACCEL_MAX
+ *  the tilt is scaled by the precomputed fixed point gain.
+ *
+ *  @param tilt The accelerometer reading relative to its balance
+ *  point, see @ref CURSOR_TILT.
+ *  @param gain The fixed point gain, see @ref CURSOR_GAIN.
+ *
+ *  @return The movement in the cursor coordinates, rounded to nearest.
+ */
+int32_t cursor_tilt_velocity(int32_t tilt, int32_t gain)
+{
+    const int shift = CURSOR_GAIN_SHIFT + CURSOR_TILT_BITS - CURSOR_SUBPIXEL_BITS;
+    return (int32_t)(((int64_t)tilt * gain + ((int64_t)1 << (shift - 1))) >> shift);
+}
+
+/** Move the cursor along a single axis and keep it on the screen.
+ *
+ *  @param axis
+ *  @param tilt The accelerometer reading relative to its balance
+ *  point, see @ref CURSOR_TILT, or the batch of them, see @ref
+ *  cursor_filter_take.
+ *  @param gain The fixed point gain, see @ref CURSOR_GAIN.
+ *  @param pull Additional movement in the cursor coordinates, see
+ *  @ref cursor_axis_pull.
+ *  @param limit The maximum position in pixels, the minimum is 0.
+ */
+void cursor_axis_move(CursorAxis* axis, int32_t tilt, int32_t gain, int32_t pull, int limit)
+{
+    const int32_t max = (int32_t)limit << CURSOR_SUBPIXEL_BITS;
+
+    axis->velocity = cursor_tilt_velocity(tilt, gain) + pull;
+    axis->position += axis->velocity;
+
+    if (axis->position < 0) {
+        axis->position = 0;
+    } else if (axis->position > max) {
+        axis->position = max;
+    }
+}
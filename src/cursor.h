@@ -0,0 +1,143 @@
+/** @file cursor.h
+ *  @brief The integer-only cursor motion engine.
+ *  @author Wojciech 'vifon' Siewierski
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#ifndef _h_CURSOR_
+#define _h_CURSOR_
+
+#include "config.h"
+
+/* Do not include pebble.h when compiling the unittests. */
+#ifndef __cplusplus
+#   include <pebble.h>             /* for bool */
+#endif
+
+#include <stdint.h>
+
+/** The accelerometer reading (in mG) which moves the cursor across
+ *  the whole screen in a single sample. */
+#define CURSOR_ACCEL_MAX 4000
+
+/** Number of the fractional bits of the cursor gains. */
+#define CURSOR_GAIN_SHIFT 26
+
+/** The gain moving the cursor by @p pixels per @ref CURSOR_ACCEL_MAX
+ *  of tilt, in pixels per mG with @ref CURSOR_GAIN_SHIFT fractional
+ *  bits. Rounded down and computed by the preprocessor, so no
+ *  floating point is involved at runtime. */
+#define CURSOR_GAIN(pixels) \
+    ((int32_t)(((int64_t)(pixels) << CURSOR_GAIN_SHIFT) / CURSOR_ACCEL_MAX))
+
+/** Number of the fractional bits of the cursor coordinates. Keeping
+ *  the fraction lets the slow tilts accumulate instead of being
+ *  truncated away on every sample. */
+#define CURSOR_SUBPIXEL_BITS 8
+
+/** A single pixel in the cursor coordinates. */
+#define CURSOR_PIXEL (1 << CURSOR_SUBPIXEL_BITS)
+
+/** The cursor state along a single axis, in pixels with @ref
+ *  CURSOR_SUBPIXEL_BITS fractional bits. */
+typedef struct {
+    /** The position, between 0 and the axis limit. */
+    int32_t position;
+    /** The movement during the last sample. */
+    int32_t velocity;
+} CursorAxis;
+
+/** The sampling rate in Hz the gains and the button steepness are
+ *  defined for, each sample at this rate moves the cursor once. */
+#define CURSOR_REFERENCE_RATE 25
+
+/** Number of the fractional bits of the tilt passed to the cursor. */
+#define CURSOR_TILT_BITS 8
+
+/** Convert the accelerometer reading in mG to the cursor tilt. */
+#define CURSOR_TILT(mg) ((int32_t)(mg) * (1 << CURSOR_TILT_BITS))
+
+/** A first order low-pass filter of the tilt along a single axis,
+ *  collecting the samples of a batch. */
+typedef struct {
+    /** The filtered tilt, see @ref CURSOR_TILT. */
+    int32_t tilt;
+    /** The sum of the filtered tilt since the last batch was taken. */
+    int32_t sum;
+} CursorFilter;
+
+/** A cheap estimate of how much the watch moves, deciding whether the
+ *  accelerometer can be sampled slower. Also counts the batches and
+ *  the samples in both modes to measure the savings. */
+typedef struct {
+    /** Whether the watch is still and the resting rate is used. */
+    bool resting;
+    /** Whether @ref last_x and @ref last_y are set. */
+    bool primed;
+    /** The previous sample. */
+    int last_x;
+    /** @copydoc last_x */
+    int last_y;
+    /** The sum of the changes between the samples of the current batch. */
+    uint32_t energy;
+    /** The number of the samples in the current batch. */
+    uint32_t samples;
+    /** The number of the consecutive still batches. */
+    uint32_t still_batches;
+
+    /** The batches (and so the wakeups) at the normal rate. */
+    uint32_t active_batches;
+    /** The batches at the resting rate. */
+    uint32_t resting_batches;
+    /** The samples at the normal rate. */
+    uint32_t active_samples;
+    /** The samples at the resting rate. */
+    uint32_t resting_samples;
+    /** The number of the switches between the rates. */
+    uint32_t switches;
+} CursorActivity;
+
+/** The balance point of the accelerometer, tracked continuously. */
+typedef struct {
+    /** Whether the balance point is set. */
+    bool calibrated;
+    /** The balance point, see @ref CURSOR_TILT. */
+    int32_t zero_x;
+    /** @copydoc zero_x */
+    int32_t zero_y;
+} CursorCalibration;
+
+void cursor_calibration_update(CursorCalibration* calibration,
+                               int32_t sum_x, int32_t sum_y, uint32_t samples,
+                               int shift);
+void cursor_activity_add(CursorActivity* activity, int x, int y);
+bool cursor_activity_update(CursorActivity* activity, bool on_button);
+uint32_t cursor_activity_batch_size(const CursorActivity* activity);
+void cursor_filter_add(CursorFilter* filter, int32_t tilt, int shift);
+int32_t cursor_filter_take(CursorFilter* filter, int rate);
+int cursor_batch_steepness(int steepness, int samples, int rate);
+void cursor_axis_set(CursorAxis* axis, int pixel);
+int cursor_axis_pixel(const CursorAxis* axis);
+int32_t cursor_axis_pull(const CursorAxis* axis, int target, int steepness);
+int32_t cursor_tilt_velocity(int32_t tilt, int32_t gain);
+void cursor_axis_move(CursorAxis* axis, int32_t tilt, int32_t gain, int32_t pull, int limit);
+
+#endif
@@ -26,9 +26,37 @@
 
 #include <stdlib.h>
 #include <string.h>
-#include <stdio.h>
 
-#include "utility.h"
+#include "calc_common.h"
+#include "wide_int.h"
+
+/** @defgroup scale Scale division
+ *  @brief Division by @ref FIXED_SCALE without the division routine.
+ *
+ *  The Pebble CPUs lack a 64-bit divide and the compiler turns the
+ *  64-bit division by a constant into a call to the generic routine,
+ *  so it is done with a multiplication by the precomputed reciprocal
+ *  followed by a shift. The 32-bit divisions by the constant scale are
+ *  left to the compiler, which already does the same.
+ *  @{
+ */
+
+/** Divide a 64-bit number by @ref FIXED_SCALE.
+ *
+ *  @param n Less than 2^63, which covers any product of two 32-bit
+ *  numbers.
+ *
+ *  @return <tt>n / FIXED_SCALE</tt>
+ */
+static inline uint64_t scale_div_u64(uint64_t n)
+{
+    return wide_umulh64(n, FIXED_DIV64_MAGIC) >> FIXED_DIV64_SHIFT;
+}
+
+/** @} */
+
+/** The powers of 10 up to @ref FIXED_SCALE. */
+static const fixed s_powers_of_10[] = {1, 10, 100, 1000, 10000};
 
 /** Sum two fixed point numbers.
  *
@@ -82,46 +110,120 @@ fixed fixed_subt(fixed lhs, fixed rhs, bool* overflow)
  */
 fixed fixed_mult(fixed lhs, fixed rhs, bool* overflow)
 {
-    if (fixed_to_int(rhs) != 0) {
-        *overflow = *overflow || abs(lhs) > abs(fixed_div(FIXED_MAX, rhs));
-    }
+    /* The product of two 32-bit numbers always fits in 64 bits, so it
+     * can be computed exactly and rescaled only once. */
+    int64_t product = (int64_t)lhs * rhs;
+
+    /* Rescale the magnitude without branching on the sign: the mask
+     * is either all zeros or all ones. */
+    uint64_t sign = (uint64_t)(product >> 63);
+    uint64_t result = scale_div_u64(((uint64_t)product ^ sign) - sign);
+
+    *overflow = *overflow || result > (uint64_t)FIXED_MAX;
 
     if (*overflow) {
         return lhs;
     }
 
-    return (lhs / FIXED_SCALE) * rhs
-        + ((lhs % FIXED_SCALE) * rhs) / FIXED_SCALE;
+    return (fixed)((result ^ sign) - sign);
 }
 
 /** Divide two fixed point numbers.
  *
  *  @param lhs
  *  @param rhs
- *
- *  @note The fractional part of @p rhs is ignored for large @p lhs
- *  due to a change in the order of performed operations made to avoid
- *  overflows.
+ *  @param[out] overflow Indicate whether the division would result
+ *  in an overflow or @p rhs is 0. If the initial value is @p true,
+ *  it will stay @p true. The returned value is unspecified if it is
+ *  true.
  *
  *  @return The result.
  */
-fixed fixed_div(fixed lhs, fixed rhs)
+fixed fixed_div(fixed lhs, fixed rhs, bool* overflow)
 {
-    /* Check if it's safe to normalize lhs instead of rhs for precision. */
-    if (lhs < FIXED_MAX / FIXED_SCALE) {
-        /* Keep precision whether possible. */
-        lhs = lhs * FIXED_SCALE;
-    } else {
-        /* Sacrifice the fractional part of rhs when the another order
-         * of operations would cause an overflow. */
-        rhs = fixed_to_int(rhs);
+    if (rhs == 0) {
+        *overflow = true;
+        return lhs;
     }
 
-    if (rhs == 0) {
-        return 0;               /* TODO: handle properly */
-    } else {
-        return lhs / rhs;
+    /* Scaling lhs in 64 bits keeps the full precision of both
+     * arguments without risking an intermediate overflow. */
+    int64_t result = (int64_t)lhs * FIXED_SCALE / rhs;
+
+    *overflow = *overflow || result > FIXED_MAX || result < -FIXED_MAX;
+
+    if (*overflow) {
+        return lhs;
     }
+
+    return (fixed)result;
+}
+
+/** Create the textual representation of the fixed point number and
+ *  return its length.
+ *
+ *  The trailing zeros of the fractional part are omitted and so is
+ *  the fractional part equal to 0.
+ *
+ *  @param n A number to represent.
+ *  @param buffer A buffer to store the representation.
+ *  @param size Size of @p buffer. The representation is truncated
+ *  to fit in it, just like with <tt>snprintf(3)</tt>.
+ *
+ *  @return The number of characters stored in @p buffer, not
+ *  counting the terminating null character.
+ */
+size_t fixed_to_str(fixed n, char* buffer, size_t size)
+{
+    if (size == 0) {
+        return 0;
+    }
+
+    uint32_t magnitude = n < 0 ? 0u - (uint32_t)n : (uint32_t)n;
+    uint32_t integral_part = magnitude / FIXED_SCALE;
+    uint32_t fractional_part = magnitude % FIXED_SCALE;
+    size_t integral_digits = calc_count_digits(integral_part);
+    size_t fractional_digits = 0;
+
+    if (fractional_part != 0) {
+        /* Remove the trailing zeros. */
+        fractional_digits = FIXED_FRACTIONAL_DIGITS;
+        while (fractional_part % 10 == 0) {
+            fractional_part /= 10;
+            --fractional_digits;
+        }
+    }
+
+    size_t length = (n < 0) + integral_digits;
+    if (fractional_digits != 0) {
+        length += 1 + fractional_digits;
+    }
+
+    if (length >= size) {
+        /* Rare enough to just represent it in full elsewhere. */
+        char full[FIXED_REPR_SIZE];
+        fixed_to_str(n, full, sizeof(full));
+        memcpy(buffer, full, size - 1);
+        buffer[size-1] = '\0';
+        return size - 1;
+    }
+
+    /* Fill the buffer from the end, two digits at a time. */
+    char* output = buffer + length;
+    *output = '\0';
+
+    if (fractional_digits != 0) {
+        output = calc_write_digits_backwards(output, fractional_part, fractional_digits);
+        *--output = '.';
+    }
+
+    output = calc_write_digits_backwards(output, integral_part, integral_digits);
+
+    if (n < 0) {
+        *--output = '-';
+    }
+
+    return length;
 }
 
 /** Create the textual representation of the fixed point number.
@@ -131,34 +233,92 @@ fixed fixed_div(fixed lhs, fixed rhs)
  *  @param size Size of @p buffer.
  *
  *  @return A pointer to the @p buffer parameter.
+ *
+ *  @see fixed_to_str
  */
 char* fixed_repr(fixed fixed, char* buffer, size_t size)
 {
-    const char* sign = (fixed < 0 ? "-" : "");
-    int integal_part = abs(fixed) / FIXED_SCALE;
-    int fractional_part = abs(fixed) % FIXED_SCALE;
+    fixed_to_str(fixed, buffer, size);
+    return buffer;
+}
 
-    if (fractional_part != 0) {
-        int n = snprintf(buffer, size,
-                         "%s%d.%02u",
-                         sign, integal_part, fractional_part);
+/** Convert at most @p length characters of a string to a fixed point
+ *  number in a single pass.
+ *
+ *  Accepts an optional minus sign, the integral part and optionally
+ *  a decimal point followed by the fractional part. The fractional
+ *  digits beyond the precision of the fixed point numbers are
+ *  consumed but ignored.
+ *
+ *  @param str String to convert. Doesn't need to be null-terminated
+ *  if @p length is given.
+ *  @param length Max number of characters to read. Pass -1 for
+ *  unlimited (the conversion stops at the null character anyway).
+ *  @param[out] endptr If non-NULL, set to the first unparsed character.
+ *  @param[out] overflow Indicate whether the conversion would
+ *  result in an overflow. If the initial value is @p true, it will
+ *  stay @p true. The returned value is unspecified if it is true.
+ *
+ *  @return The converted fixed point number.
+ */
+fixed strn_to_fixed(const char* str, size_t length, char** endptr, bool* overflow)
+{
+    bool negative = false;
+    if (length > 0 && *str == '-') {
+        negative = true;
+        ++str;
+        --length;
+    }
 
-        /* Remove the trailing zeros. */
-        if (fractional_part >= 10 &&
-            fractional_part % 10 == 0) {
+    uint32_t integral_part = 0;
+    bool too_big = false;
 
-            buffer[n-1] = '\0';
+    for (; length > 0 && *str >= '0' && *str <= '9'; ++str, --length) {
+        uint32_t digit = *str - '0';
+        if (integral_part > (FIXED_INTEGRAL_MAX - digit) / 10) {
+            too_big = true;
+        } else {
+            integral_part = integral_part * 10 + digit;
         }
-    } else {
-        snprintf(buffer, size,
-                 "%s%d",
-                 sign, integal_part);
     }
 
-    return buffer;
+    uint32_t fractional_part = 0;
+    int fractional_digits = 0;
+
+    if (length > 0 && *str == '.') {
+        ++str;
+        --length;
+
+        for (; length > 0 && *str >= '0' && *str <= '9'; ++str, --length) {
+            if (fractional_digits < FIXED_FRACTIONAL_DIGITS) {
+                fractional_part = fractional_part * 10 + (*str - '0');
+                ++fractional_digits;
+            }
+        }
+    }
+
+    /* Fewer digits than the precision -- higher order of magnitude. */
+    for (; fractional_digits < FIXED_FRACTIONAL_DIGITS; ++fractional_digits) {
+        fractional_part *= 10;
+    }
+
+    /* save the position of the first invalid character */
+    if (endptr != NULL) {
+        *endptr = (char*)str;
+    }
+
+    uint32_t result = integral_part * FIXED_SCALE + fractional_part;
+
+    *overflow = *overflow || too_big || result > (uint32_t)FIXED_MAX;
+
+    if (*overflow) {
+        return 0;
+    }
+
+    return negative ? -(fixed)result : (fixed)result;
 }
 
-/** Convert a string to a fixed point number.
+/** Convert a null-terminated string to a fixed point number.
  *
  *  @param str String to convert.
  *  @param[out] overflow Indicate whether the conversion would
@@ -166,53 +326,77 @@ char* fixed_repr(fixed fixed, char* buffer, size_t size)
  *  stay @p true. The returned value is unspecified if it is true.
  *
  *  @return The converted fixed point number.
+ *
+ *  @see strn_to_fixed
  */
 fixed str_to_fixed(const char* str, bool* overflow)
 {
-    char* fractional_start;
-    char* endptr;
-
-    int sign = 1;
-    if (*str == '-') {
-        ++str;
-        sign = -1;
-    }
+    return strn_to_fixed(str, (size_t)-1, NULL, overflow);
+}
 
-    // Detect a potential overflow.
-    static const int FIXED_MAX_digits = 8;
-    static const char* FIXED_MAX_char = "21474836"; /* FIXED_MAX/FIXED_SCALE */
-    const char* integral_end = strchr(str, '.');
-    if (integral_end == NULL) {
-        integral_end = str + strlen(str);
-    }
+/** Append a digit to the decimal notation of a number.
+ *
+ *  Used to keep the value of an edited number up to date without
+ *  parsing it again.
+ *
+ *  @param n A non-negative number being edited.
+ *  @param digit The appended digit (0-9).
+ *  @param fractional_digits The number of the digits already
+ *  present after the decimal point or -1 if it is absent.
+ *  @param[out] overflow Indicate whether the result would overflow.
+ *  If the initial value is @p true, it will stay @p true. The
+ *  returned value is unspecified if it is true.
+ *
+ *  @return The updated number. The digits beyond the precision of the
+ *  fixed point numbers are ignored.
+ */
+fixed fixed_append_digit(fixed n, int digit, int fractional_digits, bool* overflow)
+{
+    if (fractional_digits < 0) {
+        fixed digit_value = digit * FIXED_SCALE;
+        *overflow = *overflow || n > (FIXED_MAX - digit_value) / 10;
 
-    if (integral_end - str > FIXED_MAX_digits) {
-        *overflow = true;
-        return 0;
-    } else if (integral_end - str == FIXED_MAX_digits) {
-        /* strcmp will return a positive number for string
-         * lexicographically greater than FIXED_MAX_digits. For
-         * strings of the same length (which is the case in this if
-         * branch) it is the same as being numerically greater. */
-        if (strncmp(str, FIXED_MAX_char, FIXED_MAX_digits) > 0) {
-            *overflow = true;
-            return 0;
+        if (*overflow) {
+            return n;
         }
-    }
 
+        return n * 10 + digit_value;
+    } else if (fractional_digits < FIXED_FRACTIONAL_DIGITS) {
+        fixed digit_value =
+            digit * s_powers_of_10[FIXED_FRACTIONAL_DIGITS - 1 - fractional_digits];
+        *overflow = *overflow || n > FIXED_MAX - digit_value;
 
-    int integral_part = str_to_int(str, &fractional_start, -1) * FIXED_SCALE;
-    if (*fractional_start != '\0') {
-        ++fractional_start;
-    }
-    int fractional_part = str_to_int(fractional_start, &endptr, 2);
+        if (*overflow) {
+            return n;
+        }
 
-    if (endptr - fractional_start == 1) {
-        /* There was only one digit -- higher order of magnitude. */
-        fractional_part *= 10;
+        return n + digit_value;
+    } else {
+        return n;
     }
+}
 
-    return sign * (integral_part + fractional_part);
+/** Remove the last digit from the decimal notation of a number.
+ *
+ *  The reverse of @ref fixed_append_digit.
+ *
+ *  @param n A non-negative number being edited.
+ *  @param digit The removed digit (0-9).
+ *  @param fractional_digits The number of the digits after the
+ *  decimal point that will remain after the removal or -1 if the
+ *  removed digit is a part of the integral part.
+ *
+ *  @return The updated number.
+ */
+fixed fixed_remove_digit(fixed n, int digit, int fractional_digits)
+{
+    if (fractional_digits < 0) {
+        return (n - digit * FIXED_SCALE) / 10;
+    } else if (fractional_digits < FIXED_FRACTIONAL_DIGITS) {
+        return n - digit * s_powers_of_10[FIXED_FRACTIONAL_DIGITS - 1 - fractional_digits];
+    } else {
+        return n;
+    }
 }
 
 /** Convert the fixed point value to a regular integer.
@@ -237,8 +421,8 @@ fixed int_to_fixed(int n)
     return n * FIXED_SCALE;
 }
 
-/** A simple implementation of the <tt>pow(3)</tt> standard function
- *  for fixed point numbers.
+/** An implementation of the <tt>pow(3)</tt> standard function for
+ *  fixed point numbers using exponentiation by squaring.
  *
  *  @param base
  *  @param exponent
@@ -250,21 +434,443 @@ fixed int_to_fixed(int n)
  *
  *  @note The exponent is an integer, not a fixed point number.
  */
-fixed fixed_pow(fixed base, int exponent, bool* overflow)
+DEFINE_POW(fixed, FIXED_SCALE, FIXED_MAX)
+
+#if ENABLE_ELEMENTARY_FUNCTIONS
+
+/** @defgroup elementary Elementary functions
+ *  @brief Integer-only square root, exponent, logarithm and
+ *  trigonometry.
+ *
+ *  Without an FPU the libm functions would run on the soft-float
+ *  emulation, so these use shift-and-add kernels instead: the exact
+ *  bit-by-bit square root, CORDIC for the trigonometry and the
+ *  <tt>ln(1 + 2^-i)</tt> table decomposition for the exponent and the
+ *  logarithm. Every loop has a fixed iteration count. The kernels
+ *  work on 64-bit numbers with 61 fractional bits (Q61) and only the
+ *  final result is rounded to the nearest fixed point number.
+ *
+ *  Past half of the bits the steps become linear: both
+ *  <tt>atan(2^-i)</tt> and <tt>ln(1 + 2^-i)</tt> equal <tt>2^-i</tt>
+ *  within the precision. The remaining steps are then replaced with
+ *  a single first order correction.
+ *
+ *  Only built with @ref ENABLE_ELEMENTARY_FUNCTIONS.
+ *  @{
+ */
+
+/** The number of the CORDIC and the table decomposition steps
+ *  before the final correction, half of the Q61 bits. */
+#define ELEMENTARY_STEPS 32
+
+/** <tt>ln(2)</tt> in Q58. */
+#define LN2_Q58 0x2C5C85FDF473DE7LL
+
+/** <tt>ln(10)</tt> in Q58. */
+#define LN10_Q58 0x935D8DDDAAA8AC1LL
+
+/** <tt>pi/2</tt> in Q48 rounded down, the remaining bits of the Q80
+ *  value are in @ref HALF_PI_LO. */
+#define HALF_PI_HI 0x1921FB54442D1LL
+
+/** The 32 bits of <tt>pi/2</tt> below @ref HALF_PI_HI. */
+#define HALF_PI_LO 0x8469898CLL
+
+/** The inverse of the CORDIC gain in Q61. The steps past
+ *  @ref ELEMENTARY_STEPS would not change it within the precision. */
+#define CORDIC_GAIN_Q61 0x136E9DB5086BCB4DLL
+
+/** <tt>atan(2^-i)</tt> in Q61. Past the end of the table it equals
+ *  <tt>2^-i</tt> within the precision. */
+static const int64_t s_atan_table[] = {
+    0x1921FB54442D1847LL, 0x0ED63382B0DDA7B4LL, 0x07D6DD7E4B203759LL,
+    0x03FAB7535585EDB9LL, 0x01FF55BB72CFDE9CLL, 0x00FFEAADDD4BB125LL,
+    0x007FFD556EEDCA6BLL, 0x003FFFAAAB77752ELL, 0x001FFFF5555BBBB7LL,
+    0x000FFFFEAAAADDDELL, 0x0007FFFFD55556EFLL, 0x0003FFFFFAAAAAB7LL,
+    0x0001FFFFFF555556LL, 0x0000FFFFFFEAAAABLL, 0x00007FFFFFFD5555LL,
+    0x00003FFFFFFFAAABLL, 0x00001FFFFFFFF555LL, 0x00000FFFFFFFFEABLL,
+    0x000007FFFFFFFFD5LL, 0x000003FFFFFFFFFBLL, 0x000001FFFFFFFFFFLL,
+};
+
+/** <tt>ln(1 + 2^-(i + 1))</tt> in Q61. Past the end of the table it
+ *  equals <tt>2^-(i + 1)</tt> within the precision. */
+static const int64_t s_ln1p_table[] = {
+    0x0CF991F65FCC25F9LL, 0x0723FDF1E6A6886BLL, 0x03C4E0EDC55E5CBDLL,
+    0x01F0A30C01162A66LL, 0x00FC14D873C19802LL, 0x007F02A2C3F00F8FLL,
+    0x003FC054D620CF12LL, 0x001FF00AA2B10BC0LL, 0x000FFC0154D58873LL,
+    0x0007FF002AA2AC44LL, 0x0003FFC00554D562LL, 0x0001FFF000AAA2ABLL,
+    0x0000FFFC001554D5LL, 0x00007FFF0002AAA3LL, 0x00003FFFC0005555LL,
+    0x00001FFFF0000AABLL, 0x00000FFFFC000155LL, 0x000007FFFF00002BLL,
+    0x000003FFFFC00005LL, 0x000001FFFFF00001LL, 0x000000FFFFFC0000LL,
+    0x0000007FFFFF0000LL, 0x0000003FFFFFC000LL, 0x0000001FFFFFF000LL,
+    0x0000000FFFFFFC00LL, 0x00000007FFFFFF00LL, 0x00000003FFFFFFC0LL,
+    0x00000001FFFFFFF0LL, 0x00000000FFFFFFFCLL, 0x000000007FFFFFFFLL,
+};
+
+/** <tt>atan(2^-i)</tt> in Q61. */
+static inline int64_t atan_pow2(int i)
 {
-    fixed result = FIXED_SCALE;
+    if (i < (int)(sizeof(s_atan_table) / sizeof(s_atan_table[0]))) {
+        return s_atan_table[i];
+    } else {
+        return (int64_t)1 << (61 - i);
+    }
+}
 
-    bool negative = exponent < 0;
-    exponent = abs(exponent);
+/** <tt>ln(1 + 2^-i)</tt> in Q61, @p i at least 1. */
+static inline int64_t ln1p_pow2(int i)
+{
+    if (i <= (int)(sizeof(s_ln1p_table) / sizeof(s_ln1p_table[0]))) {
+        return s_ln1p_table[i - 1];
+    } else {
+        return (int64_t)1 << (61 - i);
+    }
+}
 
-    while (exponent-- && *overflow == false) {
-        result = fixed_mult(result, base, overflow);
+/** Shift a 128-bit number right, rounding to nearest.
+ *
+ *  @param hi The high 64 bits.
+ *  @param lo The low 64 bits.
+ *  @param shift Between 1 and 127.
+ *
+ *  @return The shifted number or UINT64_MAX if it does not fit.
+ */
+static uint64_t round_shift_128(uint64_t hi, uint64_t lo, int shift)
+{
+    if (shift <= 64) {
+        uint64_t half = (uint64_t)1 << (shift - 1);
+        lo += half;
+        hi += lo < half;
+    } else {
+        hi += (uint64_t)1 << (shift - 65);
     }
 
-    if (negative) {
-        return fixed_div(int_to_fixed(1),
-                         result);
+    if (shift >= 64) {
+        return hi >> (shift - 64);
+    } else if (hi >> shift != 0) {
+        return UINT64_MAX;
     } else {
-        return result;
+        return (lo >> shift) | (hi << (64 - shift));
+    }
+}
+
+/** Convert a number with @p bits fractional bits to the nearest
+ *  fixed point number.
+ *
+ *  @param n
+ *  @param bits Between 1 and 127.
+ *  @param[out] overflow Set if the result is out of range. If the
+ *  initial value is @p true, it will stay @p true.
+ *
+ *  @return The converted number.
+ */
+static fixed binary_to_fixed(int64_t n, int bits, bool* overflow)
+{
+    uint64_t magnitude = n < 0 ? 0 - (uint64_t)n : (uint64_t)n;
+    uint64_t hi;
+    uint64_t lo = wide_mul_u64(magnitude, FIXED_SCALE, &hi);
+    uint64_t result = round_shift_128(hi, lo, bits);
+
+    if (result > (uint64_t)FIXED_MAX) {
+        *overflow = true;
+        return 0;
+    }
+    return n < 0 ? -(fixed)result : (fixed)result;
+}
+
+/** Rotate the vector (@p x, @p y) by @p z radians in Q61, scaling
+ *  it by the CORDIC gain.
+ *
+ *  @param[in,out] x
+ *  @param[in,out] y
+ *  @param z At most about 1.74 radians in magnitude.
+ */
+static void cordic_rotate(int64_t* x, int64_t* y, int64_t z)
+{
+    int64_t cx = *x;
+    int64_t cy = *y;
+    int i;
+    for (i = 0; i < ELEMENTARY_STEPS; ++i) {
+        /* Rotate toward z == 0 without branching on its sign: the
+         * mask is either all zeros or all ones and negates the steps. */
+        int64_t sign = z >> 63;
+        int64_t dx = cy >> i;
+        int64_t dy = cx >> i;
+        cx -= (dx ^ sign) - sign;
+        cy += (dy ^ sign) - sign;
+        z -= (atan_pow2(i) ^ sign) - sign;
+    }
+
+    /* The remaining angle is below 2^-31, rotate by it directly:
+     * sin(z) == z and cos(z) == 1 within the precision. */
+    *x = cx - (((cy >> 30) * z) >> 31);
+    *y = cy + (((cx >> 30) * z) >> 31);
+}
+
+/** Reduce the fixed point angle to <tt>[-pi/4, pi/4]</tt>.
+ *
+ *  @param n The angle in radians.
+ *  @param[out] quadrant The number of the subtracted <tt>pi/2</tt>.
+ *
+ *  @return The remaining angle in Q61.
+ */
+static int64_t reduce_half_pi(fixed n, int64_t* quadrant)
+{
+    /* n * 2^48 and q * pi/2 * 2^48 are compared in the units of
+     * 2^-48 / FIXED_SCALE, with the low bits of pi/2 added
+     * separately. The unsigned arithmetic wraps around, but the
+     * difference is small enough to be exact. */
+    const int64_t step = FIXED_SCALE * HALF_PI_HI;
+    const int64_t half = step >> 19;
+    int64_t q = ((int64_t)n * ((int64_t)1 << 30) + (n < 0 ? -half : half)) / (step >> 18);
+    int64_t rest = 0;
+    int i;
+
+    /* The estimate is off by at most one. */
+    for (i = 0; i < 3; ++i) {
+        int64_t low = q * FIXED_SCALE * HALF_PI_LO;
+        rest = (int64_t)(((uint64_t)(int64_t)n << 48)
+                         - (uint64_t)q * (uint64_t)step
+                         - (uint64_t)((low + ((int64_t)1 << 31)) >> 32));
+        if (rest > step / 2) {
+            ++q;
+        } else if (rest < -step / 2) {
+            --q;
+        } else {
+            break;
+        }
+    }
+    *quadrant = q;
+
+    uint64_t magnitude = rest < 0 ? 0 - (uint64_t)rest : (uint64_t)rest;
+    int64_t angle = (int64_t)wide_div_small(magnitude >> 51, magnitude << 13, FIXED_SCALE);
+    return rest < 0 ? -angle : angle;
+}
+
+/** The square root of a fixed point number.
+ *
+ *  @param n
+ *  @param[out] overflow Indicate whether @p n is negative. If the
+ *  initial value is @p true, it will stay @p true. The returned value
+ *  is unspecified if it is true.
+ *
+ *  @return The square root rounded to the nearest fixed point number.
+ */
+fixed fixed_sqrt(fixed n, bool* overflow)
+{
+    if (n < 0) {
+        *overflow = true;
+        return 0;
+    }
+
+    /* sqrt(n / FIXED_SCALE) * FIXED_SCALE == sqrt(n * FIXED_SCALE)
+     * which is below 2^46. */
+    int64_t square = (int64_t)n * FIXED_SCALE;
+    int64_t root = 0;
+    int64_t bit = (int64_t)1 << 46;
+    int i;
+    for (i = 0; i < 24; ++i) {
+        /* All ones if the bit is set in the root, without a branch. */
+        int64_t trial = root + bit;
+        int64_t mask = ~((square - trial) >> 63);
+        square -= trial & mask;
+        root = (root >> 1) + (bit & mask);
+        bit >>= 2;
+    }
+
+    /* square is now the remainder, round up past root + 1/2. */
+    return (fixed)(square > root ? root + 1 : root);
+}
+
+/** An implementation of the <tt>exp(3)</tt> standard function for
+ *  fixed point numbers.
+ *
+ *  @param n
+ *  @param[out] overflow Indicate whether the result is out of range.
+ *  If the initial value is @p true, it will stay @p true. The
+ *  returned value is unspecified if it is true.
+ *
+ *  @return <tt>e</tt> raised to the power of @p n.
+ */
+fixed fixed_exp(fixed n, bool* overflow)
+{
+    /* e^24 is out of range and e^-24 rounds to 0 for any scale. */
+    if (n > 24 * FIXED_SCALE) {
+        *overflow = true;
+        return 0;
+    } else if (n < -24 * FIXED_SCALE) {
+        return 0;
+    }
+
+    uint32_t magnitude = (uint32_t)abs(n);
+    uint32_t integral = magnitude / FIXED_SCALE;
+    uint32_t fraction = magnitude % FIXED_SCALE;
+    int64_t x = ((int64_t)integral << 58)
+        + (int64_t)wide_div_small(fraction >> 6, (uint64_t)fraction << 58, FIXED_SCALE);
+    if (n < 0) {
+        x = -x;
+    }
+
+    /* e^x == 2^k * e^r where r is in [0, ln(2)). */
+    int64_t k = x >= 0 ? x / LN2_Q58 : -((-x + LN2_Q58 - 1) / LN2_Q58);
+    int64_t r = (x - k * LN2_Q58) << 3;
+
+    /* Decompose r into a sum of ln(1 + 2^-i) and multiply the
+     * corresponding (1 + 2^-i) factors. */
+    int64_t result = (int64_t)1 << 61;
+    int i;
+    for (i = 1; i < ELEMENTARY_STEPS; ++i) {
+        /* All ones if the factor fits, without a branch. */
+        int64_t mask = ~((r - ln1p_pow2(i)) >> 63);
+        r -= ln1p_pow2(i) & mask;
+        result += (result >> i) & mask;
+    }
+
+    /* The remaining r is below 2^-31 and e^r == 1 + r. */
+    result += ((result >> 30) * r) >> 31;
+
+    return binary_to_fixed(result, 61 - (int)k, overflow);
+}
+
+/** An implementation of the <tt>log(3)</tt> standard function for
+ *  fixed point numbers.
+ *
+ *  @param n
+ *  @param[out] overflow Indicate whether @p n is not positive. If the
+ *  initial value is @p true, it will stay @p true. The returned value
+ *  is unspecified if it is true.
+ *
+ *  @return The natural logarithm of @p n.
+ */
+fixed fixed_ln(fixed n, bool* overflow)
+{
+    if (n <= 0) {
+        *overflow = true;
+        return 0;
+    }
+
+    /* n == 2^e * m where m is in [1, 2) in Q61. */
+    int e = 0;
+    while (n >> (e + 1) != 0) {
+        ++e;
+    }
+    int64_t m = (int64_t)n << (61 - e);
+
+    /* Build m out of the (1 + 2^-i) factors and sum their logarithms. */
+    int64_t product = (int64_t)1 << 61;
+    int64_t log = 0;
+    int i;
+    for (i = 1; i < ELEMENTARY_STEPS; ++i) {
+        /* All ones if the factor fits, without a branch. */
+        int64_t step = product >> i;
+        int64_t mask = ~((m - product - step) >> 63);
+        product += step & mask;
+        log += ln1p_pow2(i) & mask;
+    }
+
+    /* The remaining factor m / product is below 1 + 2^-31 and
+     * ln(1 + d) == d. */
+    log += ((m - product) << 29) / (product >> 32);
+
+    /* ln(n / FIXED_SCALE) == e * ln(2) + ln(m) - FIXED_FRACTIONAL_DIGITS * ln(10) */
+    int64_t result = e * LN2_Q58 + ((log + 4) >> 3) - FIXED_FRACTIONAL_DIGITS * LN10_Q58;
+    return binary_to_fixed(result, 58, overflow);
+}
+
+/** An implementation of the <tt>sin(3)</tt> standard function for
+ *  fixed point numbers.
+ *
+ *  @param n The angle in radians.
+ *
+ *  @return The sine of @p n.
+ */
+fixed fixed_sin(fixed n)
+{
+    int64_t quadrant;
+    int64_t x = CORDIC_GAIN_Q61;
+    int64_t y = 0;
+    bool overflow = false;
+    cordic_rotate(&x, &y, reduce_half_pi(n, &quadrant));
+
+    switch ((uint64_t)quadrant & 3) {
+    case 0:
+        return binary_to_fixed(y, 61, &overflow);
+    case 1:
+        return binary_to_fixed(x, 61, &overflow);
+    case 2:
+        return binary_to_fixed(-y, 61, &overflow);
+    default:
+        return binary_to_fixed(-x, 61, &overflow);
+    }
+}
+
+/** An implementation of the <tt>cos(3)</tt> standard function for
+ *  fixed point numbers.
+ *
+ *  @param n The angle in radians.
+ *
+ *  @return The cosine of @p n.
+ */
+fixed fixed_cos(fixed n)
+{
+    int64_t quadrant;
+    int64_t x = CORDIC_GAIN_Q61;
+    int64_t y = 0;
+    bool overflow = false;
+    cordic_rotate(&x, &y, reduce_half_pi(n, &quadrant));
+
+    switch ((uint64_t)quadrant & 3) {
+    case 0:
+        return binary_to_fixed(x, 61, &overflow);
+    case 1:
+        return binary_to_fixed(-y, 61, &overflow);
+    case 2:
+        return binary_to_fixed(-x, 61, &overflow);
+    default:
+        return binary_to_fixed(y, 61, &overflow);
     }
 }
+
+/** An implementation of the <tt>atan(3)</tt> standard function for
+ *  fixed point numbers.
+ *
+ *  @param n
+ *
+ *  @return The arc tangent of @p n in radians.
+ */
+fixed fixed_atan(fixed n)
+{
+    /* Rotate the vector (1, n) onto the x axis, accumulating the
+     * angle. Both coordinates are scaled so the longer one is in
+     * [2^59, 2^60). */
+    uint32_t longer = n < -FIXED_SCALE || n > FIXED_SCALE
+        ? (uint32_t)abs(n) : (uint32_t)FIXED_SCALE;
+    int shift = 29;
+    while (longer < (1u << 30)) {
+        longer <<= 1;
+        ++shift;
+    }
+
+    int64_t x = (int64_t)FIXED_SCALE << shift;
+    int64_t y = (int64_t)n * ((int64_t)1 << shift);
+    int64_t angle = 0;
+    bool overflow = false;
+    int i;
+    for (i = 0; i < ELEMENTARY_STEPS; ++i) {
+        int64_t sign = y >> 63;
+        int64_t dx = y >> i;
+        int64_t dy = x >> i;
+        x += (dx ^ sign) - sign;
+        y -= (dy ^ sign) - sign;
+        angle += (atan_pow2(i) ^ sign) - sign;
+    }
+
+    /* The remaining angle is below 2^-31 and atan(y / x) == y / x. */
+    angle += (y * ((int64_t)1 << 29)) / (x >> 32);
+
+    return binary_to_fixed(angle, 61, &overflow);
+}
+
+/** @} */
+
+#endif
@@ -33,25 +33,79 @@
 #endif
 
 #include <limits.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 /** The underlying fixed point representation. */
 typedef int fixed;
 
-/** The scaling factor of the fixed point numbers. */
-#define FIXED_SCALE 100
+/** @def FIXED_SCALE
+ *  The scaling factor of the fixed point numbers, 10 to the power of
+ *  @ref FIXED_FRACTIONAL_DIGITS.
+ *
+ *  @def FIXED_DIV64_MAGIC
+ *  @def FIXED_DIV64_SHIFT
+ *  The reciprocal of @ref FIXED_SCALE for the 64-bit numbers less
+ *  than 2^63: <tt>n / FIXED_SCALE == ((n * FIXED_DIV64_MAGIC) >> 64)
+ *  >> FIXED_DIV64_SHIFT</tt>.
+ *
+ *  Generated with fixed_scale.hpp, the unittests check that they match.
+ */
+#if FIXED_FRACTIONAL_DIGITS == 1
+#   define FIXED_SCALE 10
+#   define FIXED_DIV64_MAGIC 0x6666666666666667ULL
+#   define FIXED_DIV64_SHIFT 2
+#elif FIXED_FRACTIONAL_DIGITS == 2
+#   define FIXED_SCALE 100
+#   define FIXED_DIV64_MAGIC 0xA3D70A3D70A3D70BULL
+#   define FIXED_DIV64_SHIFT 6
+#elif FIXED_FRACTIONAL_DIGITS == 3
+#   define FIXED_SCALE 1000
+#   define FIXED_DIV64_MAGIC 0x20C49BA5E353F7CFULL
+#   define FIXED_DIV64_SHIFT 7
+#elif FIXED_FRACTIONAL_DIGITS == 4
+#   define FIXED_SCALE 10000
+#   define FIXED_DIV64_MAGIC 0x346DC5D63886594BULL
+#   define FIXED_DIV64_SHIFT 11
+#else
+#   error "FIXED_FRACTIONAL_DIGITS must be between 1 and 4."
+#endif
 
 /** Maximum representable value. */
 static const fixed FIXED_MAX = INT_MAX;
 
+/** Maximum integral part of a representable value. */
+#define FIXED_INTEGRAL_MAX (INT_MAX / FIXED_SCALE)
+
+/** Number of the digits of @ref FIXED_INTEGRAL_MAX (INT_MAX has 10). */
+#define FIXED_INTEGRAL_DIGITS (10 - FIXED_FRACTIONAL_DIGITS)
+
+/** Buffer size sufficient for the textual representation of any
+ *  fixed point number: the sign, the digits, the decimal point and
+ *  the terminating null character. */
+#define FIXED_REPR_SIZE (1 + FIXED_INTEGRAL_DIGITS + 1 + FIXED_FRACTIONAL_DIGITS + 1)
+
 fixed fixed_add(fixed lhs, fixed rhs, bool* overflow);
 fixed fixed_subt(fixed lhs, fixed rhs, bool* overflow);
 fixed fixed_mult(fixed lhs, fixed rhs, bool* overflow);
-fixed fixed_div(fixed lhs, fixed rhs);
+fixed fixed_div(fixed lhs, fixed rhs, bool* overflow);
 char* fixed_repr(fixed fixed, char* buffer, size_t size);
+size_t fixed_to_str(fixed n, char* buffer, size_t size);
+fixed strn_to_fixed(const char* str, size_t length, char** endptr, bool* overflow);
 fixed str_to_fixed(const char* str, bool* overflow);
+fixed fixed_append_digit(fixed n, int digit, int fractional_digits, bool* overflow);
+fixed fixed_remove_digit(fixed n, int digit, int fractional_digits);
 int fixed_to_int(fixed n);
 fixed int_to_fixed(int n);
 fixed fixed_pow(fixed base, int exponent, bool* overflow);
 
+#if ENABLE_ELEMENTARY_FUNCTIONS
+fixed fixed_sqrt(fixed n, bool* overflow);
+fixed fixed_exp(fixed n, bool* overflow);
+fixed fixed_ln(fixed n, bool* overflow);
+fixed fixed_sin(fixed n);
+fixed fixed_cos(fixed n);
+fixed fixed_atan(fixed n);
+#endif
+
 #endif
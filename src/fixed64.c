@@ -0,0 +1,475 @@
+/** @file fixed64.c
+ *  @brief A 64-bit fixed point numbers implementation.
+ *  @author Wojciech 'vifon' Siewierski
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#include "fixed64.h"
+
+#include <limits.h>
+#include <string.h>
+
+#include "calc_common.h"
+#include "wide_int.h"
+
+#if FIXED64_SCALE != 1000000
+#   error "The reciprocal constants assume FIXED64_SCALE == 1000000."
+#endif
+
+/** The absolute value of a 64-bit fixed point number.
+ *
+ *  @param n
+ *
+ *  @return |n|, correct for @p INT64_MIN too.
+ */
+static inline uint64_t magnitude(fixed64 n)
+{
+    return n < 0 ? 0 - (uint64_t)n : (uint64_t)n;
+}
+
+/** Apply a sign to a magnitude known to be in range.
+ *
+ *  @param n
+ *  @param negative
+ *
+ *  @return @p n or @p -n.
+ */
+static inline fixed64 with_sign(uint64_t n, bool negative)
+{
+    return negative ? -(fixed64)n : (fixed64)n;
+}
+
+/** Divide a 64-bit number by @ref FIXED64_SCALE with a multiplication
+ *  by its reciprocal, as the ARM CPUs have no 64-bit divide.
+ *
+ *  @param n
+ *
+ *  @return <tt>n / FIXED64_SCALE</tt>
+ */
+static inline uint64_t scale_div_u64(uint64_t n)
+{
+    /* 0x431BDE82D7B634DB == ceil(2^82 / 10^6), exact for the whole
+     * 64-bit range. */
+    return wide_umulh64(n, 0x431BDE82D7B634DBULL) >> 18;
+}
+
+/** Sum two 64-bit fixed point numbers.
+ *
+ *  @param lhs
+ *  @param rhs
+ *  @param[out] overflow Indicate whether the addition would
+ *  result in an overflow. If the initial value is @p true, it will
+ *  stay @p true. The returned value is unspecified if it is true.
+ *
+ *  @return The result.
+ */
+fixed64 fixed64_add(fixed64 lhs, fixed64 rhs, bool* overflow)
+{
+    // If both arguments have the same sign...
+    if ((rhs > 0) == (lhs > 0)) {
+        // ...check for the overflow.
+        *overflow = *overflow || magnitude(lhs) > FIXED64_MAX - magnitude(rhs);
+    }
+
+    if (*overflow) {
+        return lhs;
+    }
+
+    return lhs + rhs;
+}
+
+/** Subtract two 64-bit fixed point numbers.
+ *
+ *  @param lhs
+ *  @param rhs
+ *  @param[out] overflow Indicate whether the subtraction would
+ *  result in an overflow. If the initial value is @p true, it will
+ *  stay @p true. The returned value is unspecified if it is true.
+ *
+ *  @return The result.
+ */
+fixed64 fixed64_subt(fixed64 lhs, fixed64 rhs, bool* overflow)
+{
+    return fixed64_add(lhs, -rhs, overflow);
+}
+
+/** Multiply two 64-bit fixed point numbers.
+ *
+ *  @param lhs
+ *  @param rhs
+ *  @param[out] overflow Indicate whether the multiplication would
+ *  result in an overflow. If the initial value is @p true, it will
+ *  stay @p true. The returned value is unspecified if it is true.
+ *
+ *  @return The result.
+ */
+fixed64 fixed64_mult(fixed64 lhs, fixed64 rhs, bool* overflow)
+{
+    uint64_t hi;
+    uint64_t lo = wide_mul_u64(magnitude(lhs), magnitude(rhs), &hi);
+
+    /* Otherwise the rescaled product doesn't fit even in 64 bits. */
+    *overflow = *overflow || hi >= FIXED64_SCALE;
+
+    if (*overflow) {
+        return lhs;
+    }
+
+    uint64_t result = wide_div_small(hi, lo, FIXED64_SCALE);
+
+    *overflow = result > (uint64_t)FIXED64_MAX;
+
+    if (*overflow) {
+        return lhs;
+    }
+
+    return with_sign(result, (lhs < 0) != (rhs < 0));
+}
+
+/** Divide two 64-bit fixed point numbers.
+ *
+ *  @param lhs
+ *  @param rhs
+ *  @param[out] overflow Indicate whether the division would result
+ *  in an overflow or @p rhs is 0. If the initial value is @p true,
+ *  it will stay @p true. The returned value is unspecified if it is
+ *  true.
+ *
+ *  @return The result.
+ */
+fixed64 fixed64_div(fixed64 lhs, fixed64 rhs, bool* overflow)
+{
+    if (rhs == 0) {
+        *overflow = true;
+        return lhs;
+    }
+
+    uint64_t divisor = magnitude(rhs);
+    uint64_t hi;
+    uint64_t lo = wide_mul_u64(magnitude(lhs), FIXED64_SCALE, &hi);
+
+    /* Otherwise the quotient doesn't fit even in 64 bits. */
+    *overflow = *overflow || hi >= divisor;
+
+    if (*overflow) {
+        return lhs;
+    }
+
+    uint64_t result = wide_div_u64(hi, lo, divisor);
+
+    *overflow = result > (uint64_t)FIXED64_MAX;
+
+    if (*overflow) {
+        return lhs;
+    }
+
+    return with_sign(result, (lhs < 0) != (rhs < 0));
+}
+
+/** Create the textual representation of the 64-bit fixed point
+ *  number and return its length.
+ *
+ *  The trailing zeros of the fractional part are omitted and so is
+ *  the fractional part equal to 0.
+ *
+ *  @param n A number to represent.
+ *  @param buffer A buffer to store the representation.
+ *  @param size Size of @p buffer. The representation is truncated
+ *  to fit in it, just like with <tt>snprintf(3)</tt>.
+ *
+ *  @return The number of characters stored in @p buffer, not
+ *  counting the terminating null character.
+ */
+size_t fixed64_to_str(fixed64 n, char* buffer, size_t size)
+{
+    if (size == 0) {
+        return 0;
+    }
+
+    uint64_t integral_part = scale_div_u64(magnitude(n));
+    uint32_t fractional_part = (uint32_t)(magnitude(n) - integral_part * FIXED64_SCALE);
+    size_t integral_digits = calc_count_digits(integral_part);
+    size_t fractional_digits = 0;
+
+    if (fractional_part != 0) {
+        /* Remove the trailing zeros. */
+        fractional_digits = FIXED64_FRACTIONAL_DIGITS;
+        while (fractional_part % 10 == 0) {
+            fractional_part /= 10;
+            --fractional_digits;
+        }
+    }
+
+    size_t length = (n < 0) + integral_digits;
+    if (fractional_digits != 0) {
+        length += 1 + fractional_digits;
+    }
+
+    if (length >= size) {
+        /* Rare enough to just represent it in full elsewhere. */
+        char full[FIXED64_REPR_SIZE];
+        fixed64_to_str(n, full, sizeof(full));
+        memcpy(buffer, full, size - 1);
+        buffer[size-1] = '\0';
+        return size - 1;
+    }
+
+    /* Fill the buffer from the end. */
+    char* output = buffer + length;
+    *output = '\0';
+
+    if (fractional_digits != 0) {
+        output = calc_write_digits_backwards(output, fractional_part, fractional_digits);
+        *--output = '.';
+    }
+
+    output = calc_write_digits_backwards(output, integral_part, integral_digits);
+
+    if (n < 0) {
+        *--output = '-';
+    }
+
+    return length;
+}
+
+/** Create the textual representation of the 64-bit fixed point number.
+ *
+ *  @param n A number to represent.
+ *  @param buffer A buffer to store the representation.
+ *  @param size Size of @p buffer.
+ *
+ *  @return A pointer to the @p buffer parameter.
+ *
+ *  @see fixed64_to_str
+ */
+char* fixed64_repr(fixed64 n, char* buffer, size_t size)
+{
+    fixed64_to_str(n, buffer, size);
+    return buffer;
+}
+
+/** Convert at most @p length characters of a string to a 64-bit fixed
+ *  point number in a single pass.
+ *
+ *  Accepts an optional minus sign, the integral part and optionally
+ *  a decimal point followed by the fractional part. The fractional
+ *  digits beyond the precision of the fixed point numbers are
+ *  consumed but ignored.
+ *
+ *  @param str String to convert. Doesn't need to be null-terminated
+ *  if @p length is given.
+ *  @param length Max number of characters to read. Pass -1 for
+ *  unlimited (the conversion stops at the null character anyway).
+ *  @param[out] endptr If non-NULL, set to the first unparsed character.
+ *  @param[out] overflow Indicate whether the conversion would
+ *  result in an overflow. If the initial value is @p true, it will
+ *  stay @p true. The returned value is unspecified if it is true.
+ *
+ *  @return The converted fixed point number.
+ */
+fixed64 strn_to_fixed64(const char* str, size_t length, char** endptr, bool* overflow)
+{
+    bool negative = false;
+    if (length > 0 && *str == '-') {
+        negative = true;
+        ++str;
+        --length;
+    }
+
+    /* The integral part cannot exceed this without an overflow. */
+    const uint64_t integral_max = FIXED64_MAX / FIXED64_SCALE;
+    uint64_t integral_part = 0;
+    bool too_big = false;
+
+    for (; length > 0 && *str >= '0' && *str <= '9'; ++str, --length) {
+        uint64_t digit = *str - '0';
+        if (integral_part > (integral_max - digit) / 10) {
+            too_big = true;
+        } else {
+            integral_part = integral_part * 10 + digit;
+        }
+    }
+
+    uint32_t fractional_part = 0;
+    int fractional_digits = 0;
+
+    if (length > 0 && *str == '.') {
+        ++str;
+        --length;
+
+        for (; length > 0 && *str >= '0' && *str <= '9'; ++str, --length) {
+            if (fractional_digits < FIXED64_FRACTIONAL_DIGITS) {
+                fractional_part = fractional_part * 10 + (*str - '0');
+                ++fractional_digits;
+            }
+        }
+    }
+
+    /* Fewer digits than the precision -- higher order of magnitude. */
+    for (; fractional_digits < FIXED64_FRACTIONAL_DIGITS; ++fractional_digits) {
+        fractional_part *= 10;
+    }
+
+    /* save the position of the first invalid character */
+    if (endptr != NULL) {
+        *endptr = (char*)str;
+    }
+
+    uint64_t result = integral_part * FIXED64_SCALE + fractional_part;
+
+    *overflow = *overflow || too_big || result > (uint64_t)FIXED64_MAX;
+
+    if (*overflow) {
+        return 0;
+    }
+
+    return with_sign(result, negative);
+}
+
+/** Convert a null-terminated string to a 64-bit fixed point number.
+ *
+ *  @param str String to convert.
+ *  @param[out] overflow Indicate whether the conversion would
+ *  result in an overflow. If the initial value is @p true, it will
+ *  stay @p true. The returned value is unspecified if it is true.
+ *
+ *  @return The converted fixed point number.
+ *
+ *  @see strn_to_fixed64
+ */
+fixed64 str_to_fixed64(const char* str, bool* overflow)
+{
+    return strn_to_fixed64(str, (size_t)-1, NULL, overflow);
+}
+
+/** The place values of the consecutive fractional digits. */
+static const fixed64 s_fractional_places[FIXED64_FRACTIONAL_DIGITS] = {
+    100000, 10000, 1000, 100, 10, 1,
+};
+
+/** Append a digit to the decimal notation of a number.
+ *
+ *  @param n A non-negative number being edited.
+ *  @param digit The appended digit (0-9).
+ *  @param fractional_digits The number of the digits already
+ *  present after the decimal point or -1 if it is absent.
+ *  @param[out] overflow Indicate whether the result would overflow.
+ *  If the initial value is @p true, it will stay @p true. The
+ *  returned value is unspecified if it is true.
+ *
+ *  @return The updated number. The digits beyond the precision of the
+ *  fixed point numbers are ignored.
+ *
+ *  @see fixed_append_digit
+ */
+fixed64 fixed64_append_digit(fixed64 n, int digit, int fractional_digits, bool* overflow)
+{
+    if (fractional_digits < 0) {
+        fixed64 digit_value = (fixed64)digit * FIXED64_SCALE;
+        *overflow = *overflow || n > (FIXED64_MAX - digit_value) / 10;
+
+        if (*overflow) {
+            return n;
+        }
+
+        return n * 10 + digit_value;
+    } else if (fractional_digits < FIXED64_FRACTIONAL_DIGITS) {
+        fixed64 digit_value = digit * s_fractional_places[fractional_digits];
+        *overflow = *overflow || n > FIXED64_MAX - digit_value;
+
+        if (*overflow) {
+            return n;
+        }
+
+        return n + digit_value;
+    } else {
+        return n;
+    }
+}
+
+/** Remove the last digit from the decimal notation of a number.
+ *
+ *  The reverse of @ref fixed64_append_digit.
+ *
+ *  @param n A non-negative number being edited.
+ *  @param digit The removed digit (0-9).
+ *  @param fractional_digits The number of the digits after the
+ *  decimal point that will remain after the removal or -1 if the
+ *  removed digit is a part of the integral part.
+ *
+ *  @return The updated number.
+ */
+fixed64 fixed64_remove_digit(fixed64 n, int digit, int fractional_digits)
+{
+    if (fractional_digits < 0) {
+        return (n - (fixed64)digit * FIXED64_SCALE) / 10;
+    } else if (fractional_digits < FIXED64_FRACTIONAL_DIGITS) {
+        return n - digit * s_fractional_places[fractional_digits];
+    } else {
+        return n;
+    }
+}
+
+/** Convert the 64-bit fixed point value to a regular integer.
+ *
+ *  @param n
+ *
+ *  @return The integral part of the fixed point number, clamped to
+ *  the range of @p int.
+ */
+int fixed64_to_int(fixed64 n)
+{
+    uint64_t integral_part = scale_div_u64(magnitude(n));
+
+    if (integral_part > INT_MAX) {
+        return n < 0 ? INT_MIN : INT_MAX;
+    }
+
+    return n < 0 ? -(int)integral_part : (int)integral_part;
+}
+
+/** Convert the integer to a 64-bit fixed point value.
+ *
+ *  @param n
+ *
+ *  @return The converted fixed point number.
+ */
+fixed64 int_to_fixed64(int n)
+{
+    return (fixed64)n * FIXED64_SCALE;
+}
+
+/** An implementation of the <tt>pow(3)</tt> standard function for
+ *  64-bit fixed point numbers using exponentiation by squaring.
+ *
+ *  @param base
+ *  @param exponent
+ *  @param[out] overflow Indicate whether the exponentiation would
+ *  result in an overflow. If the initial value is @p true, it will
+ *  stay @p true. The returned value is unspecified if it is true.
+ *
+ *  @return The exponentiation result.
+ *
+ *  @note The exponent is an integer, not a fixed point number.
+ *
+ *  @see fixed_pow
+ */
+DEFINE_POW(fixed64, FIXED64_SCALE, FIXED64_MAX)
@@ -0,0 +1,69 @@
+/** @file fixed64.h
+ *  @brief A 64-bit fixed point numbers implementation.
+ *  @author Wojciech 'vifon' Siewierski
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#ifndef _h_FIXED64_
+#define _h_FIXED64_
+
+#include "config.h"
+
+/* Do not include pebble.h when compiling the unittests. */
+#ifndef __cplusplus
+#   include <pebble.h>             /* for bool */
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/** The underlying 64-bit fixed point representation. */
+typedef int64_t fixed64;
+
+/** The scaling factor of the 64-bit fixed point numbers. */
+#define FIXED64_SCALE 1000000
+
+/** Number of the decimal places, @ref FIXED64_SCALE is 10 to its power. */
+#define FIXED64_FRACTIONAL_DIGITS 6
+
+/** Maximum representable value. */
+static const fixed64 FIXED64_MAX = INT64_MAX;
+
+/** Buffer size sufficient for the textual representation of any
+ *  64-bit fixed point number, including the terminating null
+ *  character. */
+#define FIXED64_REPR_SIZE 24
+
+fixed64 fixed64_add(fixed64 lhs, fixed64 rhs, bool* overflow);
+fixed64 fixed64_subt(fixed64 lhs, fixed64 rhs, bool* overflow);
+fixed64 fixed64_mult(fixed64 lhs, fixed64 rhs, bool* overflow);
+fixed64 fixed64_div(fixed64 lhs, fixed64 rhs, bool* overflow);
+char* fixed64_repr(fixed64 n, char* buffer, size_t size);
+size_t fixed64_to_str(fixed64 n, char* buffer, size_t size);
+fixed64 strn_to_fixed64(const char* str, size_t length, char** endptr, bool* overflow);
+fixed64 str_to_fixed64(const char* str, bool* overflow);
+fixed64 fixed64_append_digit(fixed64 n, int digit, int fractional_digits, bool* overflow);
+fixed64 fixed64_remove_digit(fixed64 n, int digit, int fractional_digits);
+int fixed64_to_int(fixed64 n);
+fixed64 int_to_fixed64(int n);
+fixed64 fixed64_pow(fixed64 base, int exponent, bool* overflow);
+
+#endif
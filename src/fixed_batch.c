@@ -0,0 +1,635 @@
+/** @file fixed_batch.c
+ *  @brief Array-at-a-time fixed point arithmetic.
+ *  @author Wojciech 'vifon' Siewierski
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#include "fixed_batch.h"
+
+#include <string.h>
+
+/* The vector kernels are used on the x86 hosts replaying the
+ * calculations, the watch gets the scalar loop. Define
+ * FIXED_BATCH_PORTABLE to force the latter anywhere. */
+#if !defined(FIXED_BATCH_PORTABLE) && defined(__AVX2__)
+#   include <immintrin.h>
+#   define FIXED_BATCH_VECTOR 1
+#elif !defined(FIXED_BATCH_PORTABLE) && defined(__SSE2__)
+#   include <emmintrin.h>
+#   define FIXED_BATCH_VECTOR 1
+#else
+#   define FIXED_BATCH_VECTOR 0
+#endif
+
+/** The number of lanes processed by a single vector kernel call. */
+#define FIXED_BATCH_LANES 4
+
+/** Process up to 32 lanes with the scalar functions.
+ *
+ *  @return The overflow bitmask of the processed lanes.
+ */
+typedef uint32_t (*lanes_fn)(const fixed* lhs, const fixed* rhs, fixed* result, size_t count);
+
+/** Process exactly @ref FIXED_BATCH_LANES lanes at once.
+ *
+ *  @return The overflow bitmask of the processed lanes.
+ */
+typedef uint32_t (*block_fn)(const fixed* lhs, const fixed* rhs, fixed* result);
+
+/** Count the set bits.
+ *
+ *  @param mask
+ *
+ *  @return The number of the overflowed lanes in @p mask.
+ */
+static inline size_t count_overflows(uint32_t mask)
+{
+    size_t count = 0;
+    for (; mask != 0; mask &= mask - 1) {
+        ++count;
+    }
+    return count;
+}
+
+/** Apply an operation to whole arrays, 32 lanes per bitmask word.
+ *
+ *  @param block The vector kernel, unused if there is none.
+ *  @param lanes The scalar loop used for the remaining lanes.
+ *
+ *  @see fixed_add_n
+ */
+static inline size_t apply_n(block_fn block, lanes_fn lanes,
+                             const fixed* lhs, const fixed* rhs, fixed* result,
+                             size_t n, uint32_t* overflow)
+{
+    size_t overflows = 0;
+    size_t begin;
+
+    for (begin = 0; begin < n; begin += 32) {
+        size_t count = n - begin < 32 ? n - begin : 32;
+        uint32_t mask = 0;
+        size_t i = 0;
+
+#if FIXED_BATCH_VECTOR
+        for (; i + FIXED_BATCH_LANES <= count; i += FIXED_BATCH_LANES) {
+            mask |= block(lhs + begin + i, rhs + begin + i, result + begin + i) << i;
+        }
+#else
+        (void)block;
+#endif
+        if (i < count) {
+            mask |= lanes(lhs + begin + i, rhs + begin + i, result + begin + i, count - i) << i;
+        }
+
+        overflow[begin / 32] = mask;
+        overflows += count_overflows(mask);
+    }
+
+    return overflows;
+}
+
+/** @defgroup scalar Scalar loops built on the functions from fixed.c.
+ *  @{
+ */
+
+static uint32_t add_lanes(const fixed* lhs, const fixed* rhs, fixed* result, size_t count)
+{
+    uint32_t mask = 0;
+    size_t i;
+    for (i = 0; i < count; ++i) {
+        bool overflow = false;
+        result[i] = fixed_add(lhs[i], rhs[i], &overflow);
+        mask |= (uint32_t)overflow << i;
+    }
+    return mask;
+}
+
+static uint32_t mult_lanes(const fixed* lhs, const fixed* rhs, fixed* result, size_t count)
+{
+    uint32_t mask = 0;
+    size_t i;
+    for (i = 0; i < count; ++i) {
+        bool overflow = false;
+        result[i] = fixed_mult(lhs[i], rhs[i], &overflow);
+        mask |= (uint32_t)overflow << i;
+    }
+    return mask;
+}
+
+static uint32_t div_lanes(const fixed* lhs, const fixed* rhs, fixed* result, size_t count)
+{
+    uint32_t mask = 0;
+    size_t i;
+    for (i = 0; i < count; ++i) {
+        bool overflow = false;
+        result[i] = fixed_div(lhs[i], rhs[i], &overflow);
+        mask |= (uint32_t)overflow << i;
+    }
+    return mask;
+}
+
+/** @} */
+
+#if FIXED_BATCH_VECTOR
+
+/** @defgroup vector Vector kernels.
+ *
+ *  The multiplication and division are done in double precision,
+ *  which is exact here: every operand fits in 31 bits and every
+ *  product or scaled dividend that can yield a representable result
+ *  stays below 2^31 * @ref FIXED_SCALE < 2^53. Those that don't
+ *  overflow anyway. The quotients are never close enough to an
+ *  integer for the rounding to cross it, so the truncation gives the
+ *  same result as the integer division. The out of range ones,
+ *  including the division by 0, are converted to INT_MIN, which is
+ *  outside of the symmetric range of fixed and marks the overflow.
+ *
+ *  @{
+ */
+
+/** Extract the overflow bitmask from the lanes equal to INT_MIN. */
+static inline uint32_t out_of_range_mask(__m128i result)
+{
+    __m128i invalid = _mm_cmpeq_epi32(result, _mm_set1_epi32(INT_MIN));
+    return (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(invalid));
+}
+
+static uint32_t add_block(const fixed* lhs, const fixed* rhs, fixed* result)
+{
+    __m128i a = _mm_loadu_si128((const __m128i*)lhs);
+    __m128i b = _mm_loadu_si128((const __m128i*)rhs);
+    __m128i sum = _mm_add_epi32(a, b);
+
+    /* The sum wrapped around if its sign differs from the signs of
+     * both arguments. */
+    __m128i wrapped = _mm_and_si128(_mm_xor_si128(a, sum), _mm_xor_si128(b, sum));
+
+    _mm_storeu_si128((__m128i*)result, sum);
+    return (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(wrapped)) | out_of_range_mask(sum);
+}
+
+#ifdef __AVX2__
+
+static uint32_t mult_block(const fixed* lhs, const fixed* rhs, fixed* result)
+{
+    __m256d a = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)lhs));
+    __m256d b = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)rhs));
+    __m256d quotient = _mm256_div_pd(_mm256_mul_pd(a, b), _mm256_set1_pd(FIXED_SCALE));
+    __m128i truncated = _mm256_cvttpd_epi32(quotient);
+
+    _mm_storeu_si128((__m128i*)result, truncated);
+    return out_of_range_mask(truncated);
+}
+
+static uint32_t div_block(const fixed* lhs, const fixed* rhs, fixed* result)
+{
+    __m256d a = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)lhs));
+    __m256d b = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)rhs));
+    __m256d quotient = _mm256_div_pd(_mm256_mul_pd(a, _mm256_set1_pd(FIXED_SCALE)), b);
+    __m128i truncated = _mm256_cvttpd_epi32(quotient);
+
+    _mm_storeu_si128((__m128i*)result, truncated);
+    return out_of_range_mask(truncated);
+}
+
+#else  /* SSE2 */
+
+/** Convert the upper 2 lanes to double precision. */
+static inline __m128d cvtepi32_pd_high(__m128i n)
+{
+    return _mm_cvtepi32_pd(_mm_shuffle_epi32(n, _MM_SHUFFLE(3, 2, 3, 2)));
+}
+
+/** Convert both halves back to 4 truncated integer lanes. */
+static inline __m128i cvttpd_epi32_both(__m128d low, __m128d high)
+{
+    return _mm_unpacklo_epi64(_mm_cvttpd_epi32(low), _mm_cvttpd_epi32(high));
+}
+
+static uint32_t mult_block(const fixed* lhs, const fixed* rhs, fixed* result)
+{
+    __m128i a = _mm_loadu_si128((const __m128i*)lhs);
+    __m128i b = _mm_loadu_si128((const __m128i*)rhs);
+    __m128d scale = _mm_set1_pd(FIXED_SCALE);
+
+    __m128d low = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(a), _mm_cvtepi32_pd(b)), scale);
+    __m128d high = _mm_div_pd(_mm_mul_pd(cvtepi32_pd_high(a), cvtepi32_pd_high(b)), scale);
+    __m128i truncated = cvttpd_epi32_both(low, high);
+
+    _mm_storeu_si128((__m128i*)result, truncated);
+    return out_of_range_mask(truncated);
+}
+
+static uint32_t div_block(const fixed* lhs, const fixed* rhs, fixed* result)
+{
+    __m128i a = _mm_loadu_si128((const __m128i*)lhs);
+    __m128i b = _mm_loadu_si128((const __m128i*)rhs);
+    __m128d scale = _mm_set1_pd(FIXED_SCALE);
+
+    __m128d low = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(a), scale), _mm_cvtepi32_pd(b));
+    __m128d high = _mm_div_pd(_mm_mul_pd(cvtepi32_pd_high(a), scale), cvtepi32_pd_high(b));
+    __m128i truncated = cvttpd_epi32_both(low, high);
+
+    _mm_storeu_si128((__m128i*)result, truncated);
+    return out_of_range_mask(truncated);
+}
+
+#endif
+
+/** @} */
+
+#else
+
+#define add_block NULL
+#define mult_block NULL
+#define div_block NULL
+
+#endif
+
+/** Sum the corresponding elements of two arrays.
+ *
+ *  @param lhs
+ *  @param rhs
+ *  @param[out] result May be the same array as @p lhs or @p rhs.
+ *  @param n The number of the elements.
+ *  @param[out] overflow The bitmask of the overflowed lanes, of
+ *  @ref FIXED_MASK_WORDS(n) words: lane @p i is the bit <tt>i %
+ *  32</tt> of the word <tt>i / 32</tt>. The results of these lanes
+ *  are unspecified.
+ *
+ *  @return The number of the overflowed lanes.
+ *
+ *  @see fixed_add
+ */
+size_t fixed_add_n(const fixed* lhs, const fixed* rhs, fixed* result, size_t n, uint32_t* overflow)
+{
+    return apply_n(add_block, add_lanes, lhs, rhs, result, n, overflow);
+}
+
+/** Multiply the corresponding elements of two arrays.
+ *
+ *  @see fixed_add_n
+ *  @see fixed_mult
+ */
+size_t fixed_mult_n(const fixed* lhs, const fixed* rhs, fixed* result, size_t n, uint32_t* overflow)
+{
+    return apply_n(mult_block, mult_lanes, lhs, rhs, result, n, overflow);
+}
+
+/** Divide the corresponding elements of two arrays. The division by
+ *  0 is marked as an overflow.
+ *
+ *  @see fixed_add_n
+ *  @see fixed_div
+ */
+size_t fixed_div_n(const fixed* lhs, const fixed* rhs, fixed* result, size_t n, uint32_t* overflow)
+{
+    return apply_n(div_block, div_lanes, lhs, rhs, result, n, overflow);
+}
+
+/** @defgroup swar Text conversion 8 characters at a time.
+ *
+ *  The 8 characters are kept in a 64-bit word with the first one in
+ *  the lowest byte, regardless of the byte order of the CPU.
+ *
+ *  @{
+ */
+
+/** The given byte in all 8 bytes of a word. */
+#define BYTES(byte) (0x0101010101010101ULL * (byte))
+
+/** The powers of 10 that fit in 32 bits. */
+static const uint32_t s_powers_of_10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+/** Load up to 8 characters, padding them with null characters past
+ *  the @p end.
+ *
+ *  @param str
+ *  @param end One past the last character that may be read.
+ *
+ *  @return The characters, the first one in the lowest byte.
+ */
+static inline uint64_t load_chars(const char* str, const char* end)
+{
+    uint64_t chars = 0;
+    if (end - str >= 8) {
+        memcpy(&chars, str, 8);
+    } else {
+        memcpy(&chars, str, end - str);
+    }
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    chars = __builtin_bswap64(chars);
+#endif
+    return chars;
+}
+
+/** Store 8 characters, the first one from the lowest byte.
+ *
+ *  @param out
+ *  @param chars
+ */
+static inline void store_chars(char* out, uint64_t chars)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    chars = __builtin_bswap64(chars);
+#endif
+    memcpy(out, &chars, 8);
+}
+
+/** Count the decimal digits at the beginning of 8 characters.
+ *
+ *  @param chars
+ *
+ *  @return The number of the leading digits, 0 to 8.
+ */
+static inline unsigned int count_leading_digits(uint64_t chars)
+{
+    /* Set the high bit of each byte between '0' and '9'. The high
+     * bits are masked out first, so nothing carries between the
+     * bytes, and the non-ASCII bytes are rejected separately. */
+    uint64_t low_bits = chars & BYTES(0x7F);
+    uint64_t below_colon = BYTES(0x7F + ':') - low_bits;
+    uint64_t above_slash = low_bits + BYTES(0x7F - '/');
+    uint64_t digits = below_colon & above_slash & ~chars & BYTES(0x80);
+
+    uint64_t non_digits = ~digits & BYTES(0x80);
+    return non_digits == 0 ? 8 : (unsigned int)__builtin_ctzll(non_digits) / 8;
+}
+
+/** Convert the leading decimal digits of 8 characters to a number.
+ *
+ *  @param chars
+ *  @param count The number of the digits to convert, 1 to 8. The
+ *  remaining characters are ignored.
+ *
+ *  @return The number.
+ */
+static inline uint32_t parse_digits(uint64_t chars, unsigned int count)
+{
+    /* Discard the other characters by moving the digits to the top,
+     * the vacated bytes become the leading zeros. Nothing borrows
+     * from the digits in the subtraction, as they are all above '0'. */
+    uint64_t digits = (chars - BYTES('0')) << (8 * (8 - count));
+
+    /* Combine the adjacent digits into the pairs, the pairs into the
+     * quadruples and these into the whole number. */
+    digits = digits * 10 + (digits >> 8);
+    digits = (((digits & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)))
+              + (((digits >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32))))
+        >> 32;
+    return (uint32_t)digits;
+}
+
+/** Convert a number to 8 decimal digits, the reverse of @ref
+ *  parse_digits.
+ *
+ *  @param n Less than 10^8.
+ *
+ *  @return The digit values (not characters), the most significant
+ *  one in the lowest byte, padded with the leading zeros.
+ */
+static inline uint64_t split_digits(uint32_t n)
+{
+    /* Split into the quadruples, the quadruples into the pairs and
+     * the pairs into the digits. Each step divides all its parts at
+     * once with a multiplication that cannot overflow the part. */
+    uint64_t quadruples = n / 10000 | (uint64_t)(n % 10000) << 32;
+    uint64_t hundreds = ((quadruples * 5243) >> 19) & 0x0000007F0000007FULL;
+    uint64_t pairs = hundreds | (quadruples - hundreds * 100) << 16;
+    uint64_t tens = ((pairs * 103) >> 10) & 0x000F000F000F000FULL;
+    return tens | (pairs - tens * 10) << 8;
+}
+
+/** Convert a number at the beginning of a line in the same way as
+ *  @ref strn_to_fixed.
+ *
+ *  @param str
+ *  @param end The end of the text, the newline stops the conversion
+ *  just like any other invalid character.
+ *  @param[out] endptr Set to the first unparsed character.
+ *  @param[out] overflow
+ *
+ *  @return The converted fixed point number, 0 on overflow.
+ */
+static fixed parse_number(const char* str, const char* end, const char** endptr, bool* overflow)
+{
+    bool negative = str < end && *str == '-';
+    str += negative;
+
+    /* Saturated just past the maximum, so it cannot overflow itself. */
+    uint64_t integral_part = 0;
+    unsigned int count;
+    do {
+        uint64_t chars = load_chars(str, end);
+        count = count_leading_digits(chars);
+        if (count != 0) {
+            integral_part = integral_part * s_powers_of_10[count] + parse_digits(chars, count);
+            if (integral_part > FIXED_INTEGRAL_MAX) {
+                integral_part = FIXED_INTEGRAL_MAX + 1;
+            }
+        }
+        str += count;
+    } while (count == 8);
+
+    uint32_t fractional_part = 0;
+
+    /* Only the leading fractional digits matter, the rest of them is
+     * skipped along with the rest of the line. */
+    if (str < end && *str == '.') {
+        ++str;
+        uint64_t chars = load_chars(str, end);
+        count = count_leading_digits(chars);
+        str += count;
+        if (count > FIXED_FRACTIONAL_DIGITS) {
+            count = FIXED_FRACTIONAL_DIGITS;
+        }
+        if (count != 0) {
+            fractional_part = parse_digits(chars, count)
+                * s_powers_of_10[FIXED_FRACTIONAL_DIGITS - count];
+        }
+    }
+
+    *endptr = str;
+
+    uint64_t result = integral_part * FIXED_SCALE + fractional_part;
+
+    *overflow = result > (uint64_t)FIXED_MAX;
+
+    if (*overflow) {
+        return 0;
+    }
+
+    return negative ? -(fixed)result : (fixed)result;
+}
+
+/** Write a number followed by a newline, in the same way as @ref
+ *  fixed_to_str.
+ *
+ *  @param out Needs at least @ref FIXED_REPR_SIZE + 16 bytes, as the
+ *  digits are stored 8 at a time.
+ *  @param n
+ *
+ *  @return The end of the written line.
+ */
+static char* write_line(char* out, fixed n)
+{
+    uint32_t magnitude = n < 0 ? 0u - (uint32_t)n : (uint32_t)n;
+    uint32_t integral_part = magnitude / FIXED_SCALE;
+    uint32_t fractional_part = magnitude - integral_part * FIXED_SCALE;
+
+    *out = '-';
+    out += n < 0;
+
+    /* At most 9 digits with a single decimal place. */
+    if (integral_part >= 100000000) {
+        *out++ = '0' + integral_part / 100000000;
+        integral_part %= 100000000;
+        store_chars(out, split_digits(integral_part) | BYTES('0'));
+        out += 8;
+    } else {
+        uint64_t digits = split_digits(integral_part);
+        unsigned int leading_zeros = integral_part == 0
+            ? 7
+            : (unsigned int)__builtin_ctzll(digits) / 8;
+        store_chars(out, (digits >> (8 * leading_zeros)) | BYTES('0'));
+        out += 8 - leading_zeros;
+    }
+
+    if (fractional_part != 0) {
+        /* Move the fractional digits to the lowest bytes and drop
+         * the trailing zeros, now in the highest ones. */
+        uint64_t digits = split_digits(fractional_part) >> (8 * (8 - FIXED_FRACTIONAL_DIGITS));
+        unsigned int trailing_zeros = (unsigned int)__builtin_clzll(digits) / 8
+            - (8 - FIXED_FRACTIONAL_DIGITS);
+        *out++ = '.';
+        store_chars(out, digits | BYTES('0'));
+        out += FIXED_FRACTIONAL_DIGITS - trailing_zeros;
+    }
+
+    *out++ = '\n';
+    return out;
+}
+
+/** @} */
+
+/** Convert the newline-separated numbers to an array.
+ *
+ *  Each line is converted just like by @ref strn_to_fixed, the
+ *  characters following the number are ignored. The last line
+ *  doesn't need to end with a newline.
+ *
+ *  @param str The text to convert. Doesn't need to be null-terminated.
+ *  @param length The length of @p str.
+ *  @param[out] result The converted numbers, 0 for the overflowed ones.
+ *  @param n The capacity of @p result, the remaining lines are ignored.
+ *  @param[out] overflow The bitmask of the overflowed numbers, as in
+ *  @ref fixed_add_n. Only the words covering the converted numbers
+ *  are written.
+ *
+ *  @return The number of the converted numbers.
+ */
+size_t strn_to_fixed_n(const char* str, size_t length, fixed* result, size_t n, uint32_t* overflow)
+{
+    const char* end = str + length;
+    size_t count = 0;
+    uint32_t mask = 0;
+
+    for (; str < end && count < n; ++count) {
+        const char* line_end;
+        bool line_overflow;
+        result[count] = parse_number(str, end, &line_end, &line_overflow);
+
+        /* Usually the number is the whole line. */
+        if (line_end < end && *line_end != '\n') {
+            line_end = (const char*)memchr(line_end, '\n', end - line_end);
+            if (line_end == NULL) {
+                line_end = end;
+            }
+        }
+
+        mask |= (uint32_t)line_overflow << (count % 32);
+
+        if (count % 32 == 31) {
+            overflow[count / 32] = mask;
+            mask = 0;
+        }
+
+        str = line_end + 1;
+    }
+
+    if (count % 32 != 0) {
+        overflow[count / 32] = mask;
+    }
+
+    return count;
+}
+
+/** Represent an array of numbers as text, one number per line.
+ *
+ *  Each number is represented just like by @ref fixed_to_str and
+ *  followed by a newline. The text is null-terminated.
+ *
+ *  @param numbers
+ *  @param n The number of the elements of @p numbers.
+ *  @param buffer A buffer to store the text. A buffer of <tt>n *
+ *  FIXED_REPR_SIZE + 1</tt> characters always suffices.
+ *  @param size Size of @p buffer. The numbers that don't fit in it
+ *  completely are omitted.
+ *  @param[out] endptr If non-NULL, set to the terminating null
+ *  character.
+ *
+ *  @return The number of the represented numbers.
+ */
+size_t fixed_to_str_n(const fixed* numbers, size_t n, char* buffer, size_t size, char** endptr)
+{
+    char* out = buffer;
+    char* const end = buffer + size;
+    size_t count = 0;
+
+    /* Store the digits 8 at a time while there is room to spare... */
+    for (; count < n && end - out >= FIXED_REPR_SIZE + 16; ++count) {
+        out = write_line(out, numbers[count]);
+    }
+
+    /* ...and then one by one, until the buffer is full. */
+    for (; count < n; ++count) {
+        char line[FIXED_REPR_SIZE];
+        size_t length = fixed_to_str(numbers[count], line, sizeof(line));
+        if ((size_t)(end - out) < length + 2) {
+            break;
+        }
+        memcpy(out, line, length);
+        out += length;
+        *out++ = '\n';
+    }
+
+    if (out < end) {
+        *out = '\0';
+    }
+    if (endptr != NULL) {
+        *endptr = out;
+    }
+
+    return count;
+}
+
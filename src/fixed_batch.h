@@ -0,0 +1,39 @@
+/** @file fixed_batch.h
+ *  @brief Array-at-a-time fixed point arithmetic.
+ *  @author Wojciech 'vifon' Siewierski
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#ifndef _h_FIXED_BATCH_
+#define _h_FIXED_BATCH_
+
+#include "fixed.h"
+
+/** The number of the 32-bit words of an overflow bitmask of @p n lanes. */
+#define FIXED_MASK_WORDS(n) (((n) + 31) / 32)
+
+size_t fixed_add_n(const fixed* lhs, const fixed* rhs, fixed* result, size_t n, uint32_t* overflow);
+size_t fixed_mult_n(const fixed* lhs, const fixed* rhs, fixed* result, size_t n, uint32_t* overflow);
+size_t fixed_div_n(const fixed* lhs, const fixed* rhs, fixed* result, size_t n, uint32_t* overflow);
+size_t strn_to_fixed_n(const char* str, size_t length, fixed* result, size_t n, uint32_t* overflow);
+size_t fixed_to_str_n(const fixed* numbers, size_t n, char* buffer, size_t size, char** endptr);
+
+#endif
@@ -0,0 +1,128 @@
+/** @file fixed_scale.hpp
+ *  @brief Compile-time derivation of the fixed point scale constants.
+ *  @author Wojciech 'vifon' Siewierski
+ *
+ *  The C sources cannot compute these, so fixed.h contains their
+ *  pregenerated values for each supported scale. This template is
+ *  the reference they are checked against in the unittests and can
+ *  be used to derive them for the host code.
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#ifndef _h_FIXED_SCALE_
+#define _h_FIXED_SCALE_
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+namespace fixed_scale_detail {
+
+typedef unsigned __int128 uint128;
+
+constexpr int32_t pow10(int exponent)
+{
+    return exponent == 0 ? 1 : 10 * pow10(exponent - 1);
+}
+
+constexpr int count_digits(int32_t n)
+{
+    return n < 10 ? 1 : 1 + count_digits(n / 10);
+}
+
+/** <tt>ceil(2^shift / divisor)</tt> */
+constexpr uint128 reciprocal(uint32_t divisor, int shift)
+{
+    return (((uint128)1 << shift) + divisor - 1) / divisor;
+}
+
+/** Check whether <tt>(n * reciprocal(divisor, shift)) >> shift</tt>
+ *  fits in @p width bits and equals <tt>n / divisor</tt> for all the
+ *  @p bits wide numbers. The rounding error of the reciprocal needs
+ *  to stay below <tt>2^(shift - bits)</tt>. */
+constexpr bool is_exact(uint32_t divisor, int shift, int bits, int width)
+{
+    return reciprocal(divisor, shift) >> width == 0
+        && reciprocal(divisor, shift) * divisor - ((uint128)1 << shift)
+               <= (uint128)1 << (shift - bits);
+}
+
+/** Find the smallest shift at least @p shift for which the
+ *  reciprocal is exact. */
+constexpr int find_shift(uint32_t divisor, int shift, int bits, int width)
+{
+    return is_exact(divisor, shift, bits, width)
+        ? shift
+        : find_shift(divisor, shift + 1, bits, width);
+}
+
+} // namespace fixed_scale_detail
+
+/** The constants of the 32-bit fixed point numbers with @p Digits
+ *  decimal places, matching the ones defined in fixed.h.
+ */
+template <int Digits>
+struct fixed_scale
+{
+    static_assert(Digits >= 1 && Digits <= 4,
+                  "The scale must have between 1 and 4 decimal places.");
+
+    /** @see FIXED_FRACTIONAL_DIGITS */
+    static constexpr int fractional_digits = Digits;
+
+    /** @see FIXED_SCALE */
+    static constexpr int32_t scale = fixed_scale_detail::pow10(Digits);
+
+    /** @see FIXED_INTEGRAL_MAX */
+    static constexpr int32_t integral_max = INT_MAX / scale;
+
+    /** @see FIXED_INTEGRAL_DIGITS */
+    static constexpr int integral_digits = fixed_scale_detail::count_digits(integral_max);
+
+    /** @see FIXED_REPR_SIZE */
+    static constexpr size_t repr_size = 1 + integral_digits + 1 + Digits + 1;
+
+    /** @see FIXED_DIV64_SHIFT, counted after taking the high 64 bits
+     *  of the product. */
+    static constexpr int div64_shift = fixed_scale_detail::find_shift(scale, 64, 63, 64) - 64;
+
+    /** @see FIXED_DIV64_MAGIC */
+    static constexpr uint64_t div64_magic =
+        (uint64_t)fixed_scale_detail::reciprocal(scale, 64 + div64_shift);
+
+    /** Divide a 64-bit number less than 2^63 by the scale. */
+    static constexpr uint64_t div(uint64_t n)
+    {
+        return (uint64_t)(((fixed_scale_detail::uint128)n * div64_magic) >> 64) >> div64_shift;
+    }
+};
+
+/* The out-of-class definitions required by C++11 if the members are
+ * bound to references, as in the unittest assertions. */
+template <int Digits> constexpr int fixed_scale<Digits>::fractional_digits;
+template <int Digits> constexpr int32_t fixed_scale<Digits>::scale;
+template <int Digits> constexpr int32_t fixed_scale<Digits>::integral_max;
+template <int Digits> constexpr int fixed_scale<Digits>::integral_digits;
+template <int Digits> constexpr size_t fixed_scale<Digits>::repr_size;
+template <int Digits> constexpr int fixed_scale<Digits>::div64_shift;
+template <int Digits> constexpr uint64_t fixed_scale<Digits>::div64_magic;
+
+#endif
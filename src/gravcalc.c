@@ -25,12 +25,19 @@
 
 #include <pebble.h>
 
+#include "cursor.h"
 #include "fixed.h"
+#include "fixed64.h"
+#include "keypad.h"
+#include "operation.h"
+#include "qfixed.h"
 
 static Window *s_main_window;
 
-/** Number of keys on the calculator keypad. */
-#define KEY_COUNT 16
+/** The window listing the whole calculator stack. */
+static Window *s_stack_window;
+/** The list in @ref s_stack_window, drawing only the visible rows. */
+static MenuLayer *s_stack_menu_layer;
 
 /** Number of switchable keypads */
 #define KEYPAD_COUNT 1
@@ -47,24 +54,41 @@ static size_t s_current_keypad = 0;
 
 /** The layer with the keys and their borders. */
 static Layer *s_keypad_layer;
-/** The layer with the current input, the stack state and their background. */
+/** The keypad rasterized with no key focused, drawn instead of the
+ *  keys. NULL until the first redraw and after the keypad changes.
+ *  As big as the keypad on the screen: about 18 KB of heap on basalt,
+ *  2.5 KB on aplite. */
+static GBitmap *s_keypad_cache;
+/** The layer with the background of the input box and the error
+ *  message. */
 static Layer *s_input_layer;
-/** The layer with the cursor. Has identical bounds as @ref s_keypad_layer. */
+/** The child of @ref s_input_layer with the top of the stack. */
+static Layer *s_stack_layer;
+/** The child of @ref s_input_layer with the current input. */
+static Layer *s_entry_layer;
+/** The layer with the cursor, a child of @ref s_keypad_layer just
+ *  big enough for the cursor and moved along with it. */
 static Layer *s_cursor_layer;
 
-/** A pointer to the button currently focused with the cursor. Used to
- *  not search for that button multiple times per frame, once in every
- *  hook. It is set in @ref draw_keypad_callback and used in other
- *  callbacks and handlers. <b>Is considered valid only if @ref
+/** The bounds of the button currently focused with the cursor. It is
+ *  set in @ref update_focused_button and used in other callbacks and
+ *  handlers. <b>Is considered valid only if @ref
  *  s_focused_button_index is not equal -1</b>.
  */
 static GRect s_focused_button;
 
 /** Index of the button pointed by @ref s_focused_button.
- *  -1 means it wasn't yet set.
+ *  -1 means it wasn't yet set. The last button stays focused while
+ *  the cursor crosses the gaps between the buttons.
  */
 static int s_focused_button_index = -1;
 
+/** Whether the cursor is inside @ref s_focused_button. Only then the
+ *  button is drawn highlighted, in the gaps it only stays the click
+ *  target.
+ */
+static bool s_cursor_on_focused_button = false;
+
 /** Calculations stack. */
 static CALC_TYPE s_calculator_stack[CALC_STACK_SIZE];
 /** Currently used stack slots in @ref s_calculator_stack. */
@@ -76,10 +100,60 @@ static char s_input_buffer[INPUT_BUFFER_SIZE] = "";
 static size_t s_input_length = 0;
 /** Flag marking whether inserting a comma should be allowed. */
 static bool s_editing_fractional_part = false;
+/** The absolute value of the number in @ref s_input_buffer, updated
+ *  on every edit so it never needs to be parsed. */
+static CALC_TYPE s_input_value = 0;
+/** Flag marking whether the number in @ref s_input_buffer is negative. */
+static bool s_input_negative = false;
+/** Number of the digits after the decimal point in @ref s_input_buffer. */
+static int s_input_fractional_digits = 0;
 
 /** Pointer to the error message. */
 static const char* s_error_msg = 0;
 
+/** A part of the input box text, formatted only when it changes and
+ *  not on every redraw. */
+typedef struct {
+    /** The formatted text. */
+    char text[64];
+    /** Whether @ref text needs to be formatted again. */
+    bool dirty;
+} InputDisplay;
+
+/** The cached contents of @ref s_stack_layer. */
+static InputDisplay s_stack_display = {.dirty = true};
+/** The cached contents of @ref s_entry_layer. */
+static InputDisplay s_entry_display = {.dirty = true};
+
+/** The width of @ref s_entry_display as last formatted, the stack
+ *  preview ends before it. */
+static int16_t s_entry_width;
+
+/** Number of the formatted rows of @ref s_stack_menu_layer kept in
+ *  memory. The rows are 44px high, so no more than 5 of them are ever
+ *  visible at once, even partially. */
+#define STACK_ROW_CACHE_SIZE 6
+
+/** A formatted row of @ref s_stack_menu_layer. */
+typedef struct {
+    /** The stack slot the text was formatted from. */
+    unsigned int index;
+    /** Whether @ref text is up to date with the slot @ref index. */
+    bool valid;
+    /** The formatted text. */
+    char text[40];
+} StackRow;
+
+/** The rows of the stack window as last drawn. The slot n is kept in
+ *  the entry n % @ref STACK_ROW_CACHE_SIZE, so the visible rows never
+ *  push each other out. */
+static StackRow s_stack_rows[STACK_ROW_CACHE_SIZE];
+
+/** The font of the stack preview and the current input. */
+static GFont s_input_font;
+/** The font of the error message. */
+static GFont s_error_font;
+
 /** Width of the screen. */
 #define SCREEN_W 144
 /** Height of the screen minus the statusbar (168px - 16px). */
@@ -91,12 +165,40 @@ static const char* s_error_msg = 0;
 /** Height of the keypad. */
 #define KEYPAD_HEIGHT ((SCREEN_H) - (INPUT_BOX_HEIGHT))
 
-/** The current position of the cursor. */
+/** The radius of the cursor outline. */
+#define CURSOR_RADIUS 4
+
+/** The size of @ref s_cursor_layer, the cursor is centered in it. */
+#define CURSOR_LAYER_SIZE 10
+
+/** The current position of the cursor in pixels, as drawn. */
 static GPoint s_cursor_position =
 {SCREEN_W / 2,
  KEYPAD_HEIGHT / 2};
 
-/** Calculate the coordinates and bounds of the n-th calculator button
+/** The cursor position @ref s_cursor_layer was last moved to. */
+static GPoint s_drawn_cursor_position;
+
+/** Number of the accelerometer batches which changed what is shown. */
+static uint32_t s_redraws_performed;
+/** Number of the accelerometer batches which changed nothing visible,
+ *  like the cursor held at the screen edge or in a button. */
+static uint32_t s_redraws_skipped;
+
+/** The sub-pixel state of the cursor, @ref s_cursor_position is
+ *  derived from it. */
+static CursorAxis s_cursor_x;
+/** @copydoc s_cursor_x */
+static CursorAxis s_cursor_y;
+
+/** The current accelerometer sampling rate, lowered while the watch
+ *  is held still. */
+static AccelSamplingRate s_accel_sampling_rate = ACCEL_SAMPLING_RATE;
+
+/** The motion estimate choosing @ref s_accel_sampling_rate. */
+static CursorActivity s_cursor_activity;
+
+/** Get the coordinates and bounds of the n-th calculator button
  *  relative to the upper upper left corner of the layer.
  *
  *  @param button_index Index number of the button.
@@ -104,39 +206,64 @@ static GPoint s_cursor_position =
  *  @return GRect structure with the coordinates/bounds.
  */
 static GRect get_rect_for_button(unsigned int button_index) {
-    const unsigned int keypad_margin_x = 5;
-    const unsigned int keypad_margin_y = 4;
-    const unsigned int key_sep_x = 5;
-    const unsigned int key_sep_y = 5;
-    const unsigned int keys_in_row = 4;
-    const unsigned int usable_screen_width =
-        SCREEN_W
-        - key_sep_x * (keys_in_row-1)
-        - keypad_margin_x * 2;
-    const float key_width =    /* 0.5 added for the proper rounding */
-        ((float)usable_screen_width / keys_in_row) + 0.5;
-    const unsigned int key_height = 25;
-
-    GRect bounds = GRect(
-        /* horizontal position */
-        button_index % keys_in_row
-        * (key_width + key_sep_x)
-        + keypad_margin_x,
-        /* vertical position */
-        button_index / keys_in_row
-        * (key_height + key_sep_y)
-        + keypad_margin_y,
-        /* size */
-        key_width,
-        key_height);
-
-    return bounds;
+    const KeypadRect* rect = keypad_key_rect(button_index);
+    return GRect(rect->x, rect->y, rect->w, rect->h);
+}
+
+/** Calculate the frame of @ref s_cursor_layer centered on the cursor
+ *  position relative to the upper left corner of the keypad layer.
+ *
+ *  @return GRect structure with the coordinates/bounds.
+ */
+static GRect get_rect_for_cursor() {
+    return GRect(
+        s_cursor_position.x - CURSOR_LAYER_SIZE / 2,
+        s_cursor_position.y - CURSOR_LAYER_SIZE / 2,
+        CURSOR_LAYER_SIZE,
+        CURSOR_LAYER_SIZE);
+}
+
+/** Focus the button under the cursor, if any.
+ *
+ *  @return True if the highlighted button changed.
+ */
+static bool update_focused_button() {
+    int button_index = keypad_key_at(s_cursor_position.x, s_cursor_position.y);
+
+    /* ignore the keys marked with a space like the gaps */
+    if (button_index != -1
+        && s_keypad_text[s_current_keypad][button_index][0] == ' ') {
+        button_index = -1;
+    }
+
+    bool on_button = button_index != -1;
+    bool changed = on_button != s_cursor_on_focused_button;
+    s_cursor_on_focused_button = on_button;
+
+    if (!on_button || button_index == s_focused_button_index) {
+        return changed;
+    }
+
+    s_focused_button = get_rect_for_button(button_index);
+    s_focused_button_index = button_index;
+    return true;
+}
+
+/** Drop the rasterized keypad, it will be drawn again on the next
+ *  redraw. */
+static void invalidate_keypad_cache() {
+    if (s_keypad_cache != NULL) {
+        gbitmap_destroy(s_keypad_cache);
+        s_keypad_cache = NULL;
+    }
 }
 
 /** Switch to the next keypad.
  */
 static void keypad_next() {
     s_current_keypad = (s_current_keypad + 1) % KEYPAD_COUNT;
+    invalidate_keypad_cache();
+    layer_mark_dirty(s_keypad_layer);
 }
 
 /** @defgroup calculator Calculator functions
@@ -144,6 +271,33 @@ static void keypad_next() {
  *  @{
  */
 
+/** Mark the stack preview and the changed rows of the stack window
+ *  as changed, to be formatted again and redrawn. Must be called after
+ *  every change of the stack.
+ *
+ *  @param first_index The lowest changed slot, every slot above it
+ *  is considered changed too.
+ */
+static void stack_changed(unsigned int first_index) {
+    unsigned int i;
+    for (i = 0; i < STACK_ROW_CACHE_SIZE; ++i) {
+        if (s_stack_rows[i].index >= first_index) {
+            s_stack_rows[i].valid = false;
+        }
+    }
+
+    s_stack_display.dirty = true;
+    layer_mark_dirty(s_stack_layer);
+}
+
+/** Mark the current input as changed, to be formatted again and
+ *  redrawn. Must be called after every change of the input buffer.
+ */
+static void entry_changed() {
+    s_entry_display.dirty = true;
+    layer_mark_dirty(s_entry_layer);
+}
+
 /** Change the edited fraction part (integral or fractional).
  *
  *  @param to_fractional If true, switch to the fractional part.
@@ -164,7 +318,44 @@ static bool switch_edited_fraction_part(bool to_fractional) {
 static void clear_input() {
     s_input_length = 0;
     s_input_buffer[0] = '\0';
+    s_input_value = 0;
+    s_input_negative = false;
+    s_input_fractional_digits = 0;
     switch_edited_fraction_part(false);
+    entry_changed();
+}
+
+/** Replace the input buffer contents with a number.
+ *
+ *  @param value The number to put into the input buffer.
+ */
+static void set_input(CALC_TYPE value) {
+    if (value == 0) {
+        /* A lone leading 0 is still a leading 0 (which is invalid). */
+        clear_input();
+        return;
+    }
+
+    s_input_length = TO_STR(value, s_input_buffer, INPUT_BUFFER_SIZE);
+    s_input_negative = value < 0;
+    s_input_value = s_input_negative ? -value : value;
+
+    const char* decimal_point = memchr(s_input_buffer, '.', s_input_length);
+    if (decimal_point != NULL) {
+        s_input_fractional_digits = s_input_buffer + s_input_length - decimal_point - 1;
+    } else {
+        s_input_fractional_digits = 0;
+    }
+    switch_edited_fraction_part(decimal_point != NULL);
+    entry_changed();
+}
+
+/** Get the value of the number in the input buffer.
+ *
+ *  @return The number in @ref s_input_buffer, 0 if it is empty.
+ */
+static CALC_TYPE get_input() {
+    return s_input_negative ? -s_input_value : s_input_value;
 }
 
 /** Set the error message to be shown.
@@ -172,7 +363,10 @@ static void clear_input() {
  *  @param msg Error message. Pass NULL to disable.
  */
 static void set_error(const char* msg) {
-    s_error_msg = msg;
+    if (s_error_msg != msg) {
+        s_error_msg = msg;
+        layer_mark_dirty(s_input_layer);
+    }
 }
 
 /** Push the passed number or the value in @ref s_input_buffer to the
@@ -181,9 +375,7 @@ static void set_error(const char* msg) {
  *  @param number Pointer to the number to be pushed. Pass NULL to
  *  read the value from the input buffer.
  *
- *  @return False if there is no space on the stack or the value is
- *  out of range of the internal number representation. True
- *  otherwise.
+ *  @return False if there is no space on the stack. True otherwise.
  */
 static bool push_number(CALC_TYPE *number) {
     if (s_calculator_stack_index >= CALC_STACK_SIZE) {
@@ -193,17 +385,12 @@ static bool push_number(CALC_TYPE *number) {
     CALC_TYPE *slot = &s_calculator_stack[s_calculator_stack_index++];
 
     if (number == NULL) {
-        bool overflow = false;
-        *slot = str_to_fixed(s_input_buffer, &overflow);
-        if (overflow) {
-            set_error("OUT OF RANGE");
-            --s_calculator_stack_index;
-            return false;
-        }
+        *slot = get_input();
         clear_input();
     } else {
         *slot = *number;
     }
+    stack_changed(s_calculator_stack_index - 1);
 
     return true;
 }
@@ -216,19 +403,10 @@ static void pop_number(bool edit) {
     }
 
     if (edit) {
-        if (s_calculator_stack[s_calculator_stack_index-1] != 0) {
-            char tmp[64];
-            REPR(s_calculator_stack[s_calculator_stack_index-1], tmp, 64);
-            s_input_length = snprintf(
-                s_input_buffer, INPUT_BUFFER_SIZE,
-                ""CALC_TYPE_FMT"",
-                tmp);
-        } else {
-            /* A lone leading 0 is still a leading 0 (which is invalid). */
-            clear_input();
-        }
+        set_input(s_calculator_stack[s_calculator_stack_index-1]);
     }
     --s_calculator_stack_index;
+    stack_changed(s_calculator_stack_index);
 }
 
 /** Perform an operation using the arguments from the calculator stack.
@@ -242,50 +420,28 @@ static bool perform_operation(char op) {
         return false;
     }
 
-    bool overflow = false;
-
     CALC_TYPE lhs = s_calculator_stack[s_calculator_stack_index-1];
-    CALC_TYPE rhs = str_to_fixed(s_input_buffer, &overflow);
-
-    if (overflow) {
-        set_error("OVERFLOW");
-        return false;
-    }
-
     CALC_TYPE result;
-    switch (op) {
-    case '+':
-        result = ADD(lhs, rhs, &overflow);
-        break;
-    case '-':
-        result = SUBT(lhs, rhs, &overflow);
-        break;
-    case '*':
-        result = MULT(lhs, rhs, &overflow);
-        break;
-    case '/':
-        result = DIV(lhs, rhs);
-        break;
-    case '^':
-        result = POW(lhs, fixed_to_int(rhs), &overflow);
-        break;
-    default:
-        result = 0;
-        break;
-    }
 
-    if (overflow) {
+    switch (operation_perform(op, lhs, get_input(), &result)) {
+    case OPERATION_OK:
+        break;
+    case OPERATION_DIVISION_BY_ZERO:
+        set_error("DIV BY ZERO");
+        return false;
+    case OPERATION_OVERFLOW:
         set_error("OVERFLOW");
         return false;
     }
 
     --s_calculator_stack_index;
+    stack_changed(s_calculator_stack_index);
 
 #if ENABLE_AUTOPUSH
     push_number(&result);
     clear_input();
 #else
-    s_input_length = strlen(REPR(result, s_input_buffer, INPUT_BUFFER_SIZE));
+    set_input(result);
 #endif
 
     return true;
@@ -301,6 +457,7 @@ static bool perform_operation(char op) {
 static void append_to_input_buffer(char new_character) {
     s_input_buffer[s_input_length++] = new_character;
     s_input_buffer[s_input_length]   = '\0';
+    entry_changed();
 }
 
 /** Validate and perhaps add a new character to the input buffer.
@@ -310,7 +467,8 @@ static void append_to_input_buffer(char new_character) {
  *  - no leading zeros allowed...,
  *  - ...unless just before the decimal point, in which case it is
  *    automatically added,
- *  - minus sign allowed only at the beginning.
+ *  - minus sign allowed only at the beginning,
+ *  - the number must stay in the range of @ref CALC_TYPE.
  *
  *  @param new_character The character to append.
  */
@@ -337,6 +495,26 @@ static void validate_and_append_to_input_buffer(char new_character) {
         return;
     }
 
+    if (new_character >= '0' && new_character <= '9') {
+        bool overflow = false;
+        CALC_TYPE value = APPEND_DIGIT(
+            s_input_value, new_character - '0',
+            s_editing_fractional_part ? s_input_fractional_digits : -1,
+            &overflow);
+
+        if (overflow) {
+            set_error("OUT OF RANGE");
+            return;
+        }
+
+        s_input_value = value;
+        if (s_editing_fractional_part) {
+            ++s_input_fractional_digits;
+        }
+    } else if (new_character == '-') {
+        s_input_negative = true;
+    }
+
     append_to_input_buffer(new_character);
 }
 
@@ -348,7 +526,18 @@ static void validate_and_append_to_input_buffer(char new_character) {
  *  @note It does @b not check whether the input buffer is empty.
  */
 static void delete_from_input_buffer() {
-    if (s_input_buffer[--s_input_length] == '.') {
+    char deleted_character = s_input_buffer[--s_input_length];
+
+    if (deleted_character >= '0' && deleted_character <= '9') {
+        if (s_editing_fractional_part) {
+            --s_input_fractional_digits;
+        }
+        s_input_value = REMOVE_DIGIT(
+            s_input_value, deleted_character - '0',
+            s_editing_fractional_part ? s_input_fractional_digits : -1);
+    } else if (deleted_character == '-') {
+        s_input_negative = false;
+    } else if (deleted_character == '.') {
         if ((s_input_length == 1 && s_input_buffer[s_input_length-1] == '0') ||
             (s_input_length == 2 &&
              s_input_buffer[s_input_length-1] == '0' &&
@@ -361,6 +550,7 @@ static void delete_from_input_buffer() {
         switch_edited_fraction_part(false);
     }
     s_input_buffer[s_input_length] = '\0';
+    entry_changed();
 }
 
 /** Perform the operation associated with the clicked button.
@@ -435,10 +625,15 @@ static void cancel_click_handler(ClickRecognizerRef recognizer, void *context) {
 }
 
 /** Handler for the button used for clearing the whole input buffer.
+ *  If it is already empty, show the whole stack instead.
  */
 static void clear_input_click_handler(ClickRecognizerRef recognizer, void *context) {
     set_error(NULL);
-    clear_input();
+    if (s_input_length == 0 && s_calculator_stack_index > 0) {
+        window_stack_push(s_stack_window, true);
+    } else {
+        clear_input();
+    }
 }
 
 /** Handler for the button used for emptying the whole calculator stack.
@@ -447,6 +642,7 @@ static void empty_stack_click_handler(ClickRecognizerRef recognizer, void *conte
     set_error(NULL);
     clear_input();
     s_calculator_stack_index = 0;
+    stack_changed(0);
 }
 
 /** Handler for the button used for pushing the current input to stack.
@@ -468,7 +664,8 @@ static void switch_keypad_handler(ClickRecognizerRef recognizer, void *context)
 /** Set the button handlers.
  *
  *  <b>Upper</b>: backspace / pop from the stack<br />
- *  <b>Upper long</b>: clear the current input<br />
+ *  <b>Upper long</b>: clear the current input, show the whole stack
+ *  if it is already empty<br />
  *  <b>Middle</b>: push to the stack<br />
  *  <b>Middle long</b>: empty the stack<br />
  *  <b>Lower</b>: click / confirm<br />
@@ -490,103 +687,186 @@ static void click_config_provider(void *context) {
  *  @{
  */
 
-/** Draw the keys and their borders.
+/** Draw a single key with its border.
+ *
+ *  @param ctx
+ *  @param button_index Index number of the button.
+ *  @param focused Whether to use the colors of the focused button.
  */
-static void draw_keypad_callback(Layer *layer, GContext *ctx) {
-    const GFont font = fonts_get_system_font(FONT_KEY_GOTHIC_18_BOLD);
+static void draw_key(GContext *ctx, unsigned int button_index, bool focused) {
+    GRect bounds = get_rect_for_button(button_index);
+
+    if (focused) {
+        graphics_context_set_text_color(ctx, COLOR_BUTTON_FOCUSED_TEXT);
+        graphics_context_set_fill_color(ctx, COLOR_BUTTON_FOCUSED_BG);
+        graphics_context_set_stroke_color(ctx, COLOR_BUTTON_FOCUSED_BORDER);
+    } else {
+        graphics_context_set_text_color(ctx, COLOR_BUTTON_TEXT);
+        graphics_context_set_fill_color(ctx, COLOR_BUTTON_BG);
+        graphics_context_set_stroke_color(ctx, COLOR_BUTTON_BORDER);
+    }
+    graphics_fill_rect(ctx, bounds, 1, GCornerNone);
+    graphics_draw_rect(ctx, bounds);
+
+    graphics_draw_text(
+        ctx,
+        s_keypad_text[s_current_keypad][button_index],
+        fonts_get_system_font(FONT_KEY_GOTHIC_18_BOLD),
+        bounds,
+        GTextOverflowModeTrailingEllipsis,
+        GTextAlignmentCenter,
+        NULL);
+}
 
+/** Draw all the keys as not focused.
+ */
+static void draw_keys(GContext *ctx) {
     unsigned int i;
     for (i = 0; i < KEY_COUNT; ++i) {
         /* ignore the keys marked with a space */
         if (s_keypad_text[s_current_keypad][i][0] != ' ') {
+            draw_key(ctx, i, false);
+        }
+    }
+}
 
-            GRect bounds = get_rect_for_button(i);
+/** Copy what was drawn on a layer so far into a new bitmap.
+ *
+ *  @param ctx
+ *  @param layer A direct child of the root layer of its window,
+ *  spanning the whole width of the screen.
+ *
+ *  @return The bitmap or NULL if the layer is not wholly on the screen,
+ *  the frame buffer was not available or there was not enough memory.
+ */
+static GBitmap* capture_layer(GContext *ctx, Layer *layer) {
+    Window *window = layer_get_window(layer);
+    if (window == NULL) {
+        return NULL;
+    }
 
-            bool active = grect_contains_point(&bounds, &s_cursor_position);
+    /* convert the frame to the screen coordinates */
+    GRect frame = layer_get_frame(layer);
+    Layer *root_layer = window_get_root_layer(window);
+    GRect root_frame = layer_get_frame(root_layer);
+    GRect root_bounds = layer_get_bounds(root_layer);
+    frame.origin.x += root_frame.origin.x + root_bounds.origin.x;
+    frame.origin.y += root_frame.origin.y + root_bounds.origin.y;
+    if (frame.origin.x != 0 || frame.size.w != SCREEN_W
+        || frame.origin.y < 0 || frame.origin.y + frame.size.h > SCREEN_H) {
+        return NULL;
+    }
 
-            if (active) {
-                s_focused_button = bounds;
-                s_focused_button_index = i;
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+    if (frame_buffer == NULL) {
+        return NULL;
+    }
 
-                graphics_context_set_text_color(ctx, COLOR_BUTTON_FOCUSED_TEXT);
-                graphics_context_set_fill_color(ctx, COLOR_BUTTON_FOCUSED_BG);
-                graphics_context_set_stroke_color(ctx, COLOR_BUTTON_FOCUSED_BORDER);
-            } else {
-                graphics_context_set_text_color(ctx, COLOR_BUTTON_TEXT);
-                graphics_context_set_fill_color(ctx, COLOR_BUTTON_BG);
-                graphics_context_set_stroke_color(ctx, COLOR_BUTTON_BORDER);
-            }
-            graphics_fill_rect(ctx, bounds, 1, GCornerNone);
-            graphics_draw_rect(ctx, bounds);
-
-            graphics_draw_text(
-                ctx,
-                s_keypad_text[s_current_keypad][i],
-                font,
-                bounds,
-                GTextOverflowModeTrailingEllipsis,
-                GTextAlignmentCenter,
-                NULL);
+    GBitmap *bitmap = gbitmap_create_blank(frame.size, gbitmap_get_format(frame_buffer));
+    if (bitmap != NULL) {
+        /* Whole rows are copied, the layer is as wide as the screen. */
+        const uint16_t source_row_size = gbitmap_get_bytes_per_row(frame_buffer);
+        const uint16_t row_size = gbitmap_get_bytes_per_row(bitmap);
+        const uint16_t copied_size = source_row_size < row_size ? source_row_size : row_size;
+
+        const uint8_t *source = gbitmap_get_data(frame_buffer) + frame.origin.y * source_row_size;
+        uint8_t *destination = gbitmap_get_data(bitmap);
+        int16_t y;
+        for (y = 0; y < frame.size.h; ++y) {
+            memcpy(destination + y * row_size,
+                   source + y * source_row_size,
+                   copied_size);
         }
     }
+
+    graphics_release_frame_buffer(ctx, frame_buffer);
+    return bitmap;
 }
 
-/** Draw the current input the stack information and the background.
- *  Additionally display the error message, if any.
+/** Draw the keys and their borders.
+ *
+ *  The idle keys are drawn only once and copied into @ref
+ *  s_keypad_cache. After that the whole keypad is a single bitmap and
+ *  only the highlighted key is drawn on top of it. Without the cache
+ *  the keys are drawn directly.
  */
-static void draw_input_callback(Layer *layer, GContext *ctx) {
-    graphics_context_set_fill_color(ctx, COLOR_DISPLAY_BG);
-    graphics_context_set_text_color(ctx, COLOR_DISPLAY_TEXT);
-    graphics_fill_rect(ctx, layer_get_bounds(layer), 2, GCornerNone);
+static void draw_keypad_callback(Layer *layer, GContext *ctx) {
+    if (s_keypad_cache == NULL) {
+        draw_keys(ctx);
+        /* try again the next time if it fails */
+        s_keypad_cache = capture_layer(ctx, layer);
+    } else {
+        graphics_draw_bitmap_in_rect(ctx, s_keypad_cache, layer_get_bounds(layer));
+    }
+
+    if (s_cursor_on_focused_button) {
+        draw_key(ctx, s_focused_button_index, true);
+    }
+}
+
+/** Format the top of the stack into @ref s_stack_display.
+ */
+static void format_stack_display() {
+    char *buffer = s_stack_display.text;
+    const size_t size = sizeof(s_stack_display.text);
 
-    char buffer[64];
     switch (s_calculator_stack_index) {
         char lhs[32];
         char rhs[32];
     case 0:
-        snprintf(buffer, sizeof(buffer),
-                 "%s",
-                 s_input_length > 0 ? s_input_buffer : "0");
+        buffer[0] = '\0';
         break;
     case 1:
         REPR(s_calculator_stack[s_calculator_stack_index-1], lhs, sizeof(lhs));
-        snprintf(buffer, sizeof(buffer),
-                 ""CALC_TYPE_FMT" %s %s",
-                 lhs, "_",
-                 s_input_length > 0 ? s_input_buffer : "0");
+        snprintf(buffer, size,
+                 ""CALC_TYPE_FMT" %s",
+                 lhs, "_");
         break;
     case 2:
         REPR(s_calculator_stack[s_calculator_stack_index-1], lhs, sizeof(lhs));
         REPR(s_calculator_stack[s_calculator_stack_index-2], rhs, sizeof(rhs));
-        snprintf(buffer, sizeof(buffer),
-                 ""CALC_TYPE_FMT"  "CALC_TYPE_FMT" %s %s",
-                 rhs, lhs, "_",
-                 s_input_length > 0 ? s_input_buffer : "0");
+        snprintf(buffer, size,
+                 ""CALC_TYPE_FMT"  "CALC_TYPE_FMT" %s",
+                 rhs, lhs, "_");
         break;
     default:
         REPR(s_calculator_stack[s_calculator_stack_index-1], lhs, sizeof(lhs));
         REPR(s_calculator_stack[s_calculator_stack_index-2], rhs, sizeof(rhs));
-        snprintf(buffer, sizeof(buffer),
-                 "[%u]... "CALC_TYPE_FMT"  "CALC_TYPE_FMT" %s %s",
+        snprintf(buffer, size,
+                 "[%u]... "CALC_TYPE_FMT"  "CALC_TYPE_FMT" %s",
                  s_calculator_stack_index,
-                 rhs, lhs, "_",
-                 s_input_length > 0 ? s_input_buffer : "0");
+                 rhs, lhs, "_");
         break;
     }
 
-    /* create the text margin */
-    GRect bounds = layer_get_bounds(layer);
-    bounds.origin.x += 5;
-    bounds.size.w -= 10;
+    s_stack_display.dirty = false;
+}
 
-    graphics_draw_text(
-        ctx,
-        buffer,
-        fonts_get_system_font(FONT_KEY_GOTHIC_24_BOLD),
+/** Format the current input into @ref s_entry_display and measure it.
+ *
+ *  @param bounds The bounds the input is drawn in.
+ */
+static void format_entry_display(GRect bounds) {
+    snprintf(s_entry_display.text, sizeof(s_entry_display.text),
+             "%s",
+             s_input_length > 0 ? s_input_buffer : "0");
+
+    s_entry_width = graphics_text_layout_get_content_size(
+        s_entry_display.text,
+        s_input_font,
         bounds,
         GTextOverflowModeTrailingEllipsis,
-        GTextAlignmentRight,
-        NULL);
+        GTextAlignmentRight).w;
+
+    s_entry_display.dirty = false;
+}
+
+/** Draw the background of the input box and the error message, if
+ *  any. The text is drawn by its children.
+ */
+static void draw_input_callback(Layer *layer, GContext *ctx) {
+    graphics_context_set_fill_color(ctx, COLOR_DISPLAY_BG);
+    graphics_fill_rect(ctx, layer_get_bounds(layer), 2, GCornerNone);
 
     if (s_error_msg) {
         GRect bounds = layer_get_bounds(layer);
@@ -594,10 +874,11 @@ static void draw_input_callback(Layer *layer, GContext *ctx) {
         bounds.origin.y -= 4;
         bounds.size.w -= 10;
 
+        graphics_context_set_text_color(ctx, COLOR_DISPLAY_TEXT);
         graphics_draw_text(
             ctx,
             s_error_msg,
-            fonts_get_system_font(FONT_KEY_GOTHIC_14),
+            s_error_font,
             bounds,
             GTextOverflowModeTrailingEllipsis,
             GTextAlignmentLeft,
@@ -605,15 +886,99 @@ static void draw_input_callback(Layer *layer, GContext *ctx) {
     }
 }
 
+/** Draw the top of the stack, left of the current input. */
+static void draw_stack_callback(Layer *layer, GContext *ctx) {
+    if (s_stack_display.dirty) {
+        format_stack_display();
+    }
+
+    /* leave a space before the current input */
+    GRect bounds = layer_get_bounds(layer);
+    bounds.size.w -= s_entry_width + 5;
+
+    graphics_context_set_text_color(ctx, COLOR_DISPLAY_TEXT);
+    graphics_draw_text(
+        ctx,
+        s_stack_display.text,
+        s_input_font,
+        bounds,
+        GTextOverflowModeTrailingEllipsis,
+        GTextAlignmentRight,
+        NULL);
+}
+
+/** Draw the current input. */
+static void draw_entry_callback(Layer *layer, GContext *ctx) {
+    GRect bounds = layer_get_bounds(layer);
+
+    if (s_entry_display.dirty) {
+        format_entry_display(bounds);
+    }
+
+    graphics_context_set_text_color(ctx, COLOR_DISPLAY_TEXT);
+    graphics_draw_text(
+        ctx,
+        s_entry_display.text,
+        s_input_font,
+        bounds,
+        GTextOverflowModeTrailingEllipsis,
+        GTextAlignmentRight,
+        NULL);
+}
+
 /** Draw the cursor with an outline. */
 static void draw_cursor_callback(Layer *layer, GContext *ctx) {
+    const GPoint center = GPoint(CURSOR_LAYER_SIZE / 2, CURSOR_LAYER_SIZE / 2);
+
     /* Draw the cursor. */
     graphics_context_set_fill_color(ctx, COLOR_CURSOR);
-    graphics_fill_circle(ctx, s_cursor_position, 3);
+    graphics_fill_circle(ctx, center, CURSOR_RADIUS - 1);
 
     /* Draw the cursor outline for better visibility. */
     graphics_context_set_stroke_color(ctx, COLOR_CURSOR_BORDER);
-    graphics_draw_circle(ctx, s_cursor_position, 4);
+    graphics_draw_circle(ctx, center, CURSOR_RADIUS);
+}
+
+/** Get the number of the rows of @ref s_stack_menu_layer.
+ *
+ *  @param menu_layer
+ *  @param section_index The only section of the menu.
+ *  @param context Unused.
+ *
+ *  @return The number of the stack entries.
+ */
+static uint16_t get_stack_rows_callback(MenuLayer *menu_layer, uint16_t section_index, void *context) {
+    return s_calculator_stack_index;
+}
+
+/** Draw a single stack entry of @ref s_stack_menu_layer, the top of
+ *  the stack first.
+ *
+ *  The menu layer calls it only for the few visible rows, so only
+ *  those are kept formatted in @ref s_stack_rows instead of the text
+ *  of all the @ref CALC_STACK_SIZE slots. A row is formatted again
+ *  only if its slot changed or it was pushed out by another one.
+ *
+ *  @param ctx
+ *  @param cell_layer
+ *  @param cell_index The row, 0 is the top of the stack.
+ *  @param context Unused.
+ */
+static void draw_stack_row_callback(GContext *ctx, const Layer *cell_layer, MenuIndex *cell_index, void *context) {
+    unsigned int index = s_calculator_stack_index - 1 - cell_index->row;
+    StackRow *row = &s_stack_rows[index % STACK_ROW_CACHE_SIZE];
+
+    if (!row->valid || row->index != index) {
+        char number[32];
+        REPR(s_calculator_stack[index], number, sizeof(number));
+        snprintf(row->text, sizeof(row->text),
+                 "%u: "CALC_TYPE_FMT"",
+                 index + 1, number);
+        row->index = index;
+        row->valid = true;
+    }
+
+    menu_cell_basic_draw(ctx, cell_layer, row->text, NULL, NULL);
 }
 
 /** @} */
@@ -636,6 +1001,8 @@ static void main_window_load(Window *window) {
         draw_keypad_callback);
 
     /* Create the layer with the input box. */
+    s_input_font = fonts_get_system_font(FONT_KEY_GOTHIC_24_BOLD);
+    s_error_font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
     s_input_layer = layer_create(
         GRect(0, 0,
               144, INPUT_BOX_HEIGHT));
@@ -646,82 +1013,185 @@ static void main_window_load(Window *window) {
         s_input_layer,
         draw_input_callback);
 
-    /* Create the topmost layer with the cursor. */
-    s_cursor_layer = layer_create(
-        GRect(0, INPUT_BOX_HEIGHT,
-              144, KEYPAD_HEIGHT));
+    /* Create its children with the text margin. The current input is
+     * drawn first, the stack preview needs its width. */
+    s_entry_layer = layer_create(
+        GRect(5, 0,
+              144 - 10, INPUT_BOX_HEIGHT));
     layer_add_child(
-        window_get_root_layer(window),
+        s_input_layer,
+        s_entry_layer);
+    layer_set_update_proc(
+        s_entry_layer,
+        draw_entry_callback);
+
+    s_stack_layer = layer_create(
+        GRect(5, 0,
+              144 - 10, INPUT_BOX_HEIGHT));
+    layer_add_child(
+        s_input_layer,
+        s_stack_layer);
+    layer_set_update_proc(
+        s_stack_layer,
+        draw_stack_callback);
+
+    /* Create the layer with the cursor above the keys. It is clipped
+     * to the keypad like the cursor always was. */
+    s_cursor_layer = layer_create(get_rect_for_cursor());
+    s_drawn_cursor_position = s_cursor_position;
+    layer_add_child(
+        s_keypad_layer,
         s_cursor_layer);
     layer_set_update_proc(
         s_cursor_layer,
         draw_cursor_callback);
+
+    update_focused_button();
 }
 
 static void main_window_unload(Window *window) {
+    invalidate_keypad_cache();
+    layer_destroy(s_cursor_layer);
     layer_destroy(s_keypad_layer);
+    layer_destroy(s_entry_layer);
+    layer_destroy(s_stack_layer);
     layer_destroy(s_input_layer);
-    layer_destroy(s_cursor_layer);
 }
 
-/** Read the data from the accelerometer and then move the cursor
- *  (@ref s_cursor_position) according to them.
+/** Create the list of the stack entries. The stack cannot change
+ *  while the window is shown, so the list is never reloaded.
+ */
+static void stack_window_load(Window *window) {
+    Layer *root_layer = window_get_root_layer(window);
+
+    /* Create the scrollable list of the stack entries. */
+    s_stack_menu_layer = menu_layer_create(layer_get_bounds(root_layer));
+    menu_layer_set_callbacks(s_stack_menu_layer, NULL, (MenuLayerCallbacks) {
+        .get_num_rows = get_stack_rows_callback,
+        .draw_row = draw_stack_row_callback
+    });
+    menu_layer_set_click_config_onto_window(s_stack_menu_layer, window);
+    layer_add_child(
+        root_layer,
+        menu_layer_get_layer(s_stack_menu_layer));
+}
+
+static void stack_window_unload(Window *window) {
+    menu_layer_destroy(s_stack_menu_layer);
+}
+
+/** Switch between the normal and the resting accelerometer sampling.
+ *
+ *  @param activity Decides whether to use the resting sampling rate
+ *  and batch size.
+ */
+static void set_accel_sampling(const CursorActivity* activity) {
+    s_accel_sampling_rate = activity->resting ? ACCEL_REST_SAMPLING_RATE : ACCEL_SAMPLING_RATE;
+    accel_service_set_sampling_rate(s_accel_sampling_rate);
+    accel_service_set_samples_per_update(cursor_activity_batch_size(activity));
+}
+
+/** Read a batch of the data from the accelerometer and then move the
+ *  cursor (@ref s_cursor_position) according to them.
+ *
+ *  All the samples pass through the low-pass filter, but the cursor
+ *  is moved only once per batch and redrawn only if its pixel position
+ *  or the focused button changed.
  *
- *  @note On the first @ref CALIBRATION_SAMPLES calls only calibrate
- *  the balance point of the accelerometer by calculating the average
- *  value from them.
+ *  @note The balance point of the accelerometer is the mean of the
+ *  first batch and then follows the batches during which the watch is
+ *  held still with the cursor resting on a button.
  */
 static void read_accel_and_move_cursor_callback(AccelData *data, uint32_t num_samples) {
-    static int samples_until_calibrated = CALIBRATION_SAMPLES;
-    static int zero_x = 0;
-    static int zero_y = 0;
-
-    /* collect the sample for calibration */
-    if (samples_until_calibrated > 0) {
-        --samples_until_calibrated;
-        zero_x += data[0].x;
-        zero_y += data[0].y;
+    static CursorCalibration calibration;
+    static CursorFilter filter_x;
+    static CursorFilter filter_y;
+
+    if (num_samples == 0) {
         return;
     }
 
-    /* all samples collected, calculate the average */
-    if (samples_until_calibrated == 0) {
-        --samples_until_calibrated;
-        zero_x /= CALIBRATION_SAMPLES;
-        zero_y /= CALIBRATION_SAMPLES;
+    int32_t sum_x = 0;
+    int32_t sum_y = 0;
+    uint32_t i;
+    for (i = 0; i < num_samples; ++i) {
+        cursor_activity_add(&s_cursor_activity, data[i].x, data[i].y);
+        sum_x += data[i].x;
+        sum_y += data[i].y;
+    }
+
+    /* the first batch calibrates without waiting for more */
+    if (!calibration.calibrated) {
+        cursor_calibration_update(&calibration, sum_x, sum_y, num_samples, CALIBRATION_SHIFT);
+    }
+
+    for (i = 0; i < num_samples; ++i) {
+        cursor_filter_add(&filter_x,
+                          CURSOR_TILT(data[i].x) - calibration.zero_x,
+                          ACCEL_FILTER_SHIFT);
+        cursor_filter_add(&filter_y,
+                          -(CURSOR_TILT(data[i].y) - calibration.zero_y),
+                          ACCEL_FILTER_SHIFT);
     }
 
     /* the button is concave, simulate its steepness */
-    int x_slope = 0;
-    int y_slope = 0;
+    int32_t x_pull = 0;
+    int32_t y_pull = 0;
     if (s_focused_button_index != -1) {
         GPoint center = grect_center_point(&s_focused_button);
-        x_slope = (center.x - s_cursor_position.x);
-        y_slope = (center.y - s_cursor_position.y);
+        int steepness = cursor_batch_steepness(
+            STEEPNESS_FACTOR, num_samples, s_accel_sampling_rate);
+        x_pull = cursor_axis_pull(&s_cursor_x, center.x, steepness);
+        y_pull = cursor_axis_pull(&s_cursor_y, center.y, steepness);
     }
 
     /* apply the new position cursor */
-    const float ACCEL_MAX = 4000.f;
-    s_cursor_position.x +=
-        ((data[0].x - zero_x) * (SCREEN_W / ACCEL_MAX)
-         + x_slope / STEEPNESS_FACTOR);
-    s_cursor_position.y +=
-        (-(data[0].y - zero_y) * (SCREEN_H / ACCEL_MAX)
-         + y_slope / STEEPNESS_FACTOR);
-
-    if (s_cursor_position.x < 0) {
-        s_cursor_position.x = 0;
-    } else if (s_cursor_position.x > SCREEN_W) {
-        s_cursor_position.x = SCREEN_W;
+    cursor_axis_move(
+        &s_cursor_x,
+        cursor_filter_take(&filter_x, s_accel_sampling_rate),
+        CURSOR_GAIN(SCREEN_W),
+        x_pull,
+        SCREEN_W);
+    cursor_axis_move(
+        &s_cursor_y,
+        cursor_filter_take(&filter_y, s_accel_sampling_rate),
+        CURSOR_GAIN(SCREEN_H),
+        y_pull,
+        KEYPAD_HEIGHT);
+
+    s_cursor_position.x = cursor_axis_pixel(&s_cursor_x);
+    s_cursor_position.y = cursor_axis_pixel(&s_cursor_y);
+    bool focus_changed = update_focused_button();
+
+    /* Resting means held by the button, not just passing over it. */
+    bool resting_on_button =
+        s_cursor_on_focused_button
+        && abs(s_cursor_x.velocity) + abs(s_cursor_y.velocity) < CURSOR_PIXEL / 2;
+
+    if (cursor_activity_update(&s_cursor_activity, resting_on_button)) {
+        set_accel_sampling(&s_cursor_activity);
     }
 
-    if (s_cursor_position.y < 0) {
-        s_cursor_position.y = 0;
-    } else if (s_cursor_position.y > KEYPAD_HEIGHT) {
-        s_cursor_position.y = KEYPAD_HEIGHT;
+    /* follow the drift while nobody is trying to move the cursor */
+    if (s_cursor_activity.still_batches > 0) {
+        cursor_calibration_update(&calibration, sum_x, sum_y, num_samples, CALIBRATION_SHIFT);
     }
 
-    layer_mark_dirty(s_cursor_layer);
+    /* redraw only if anything visible changed */
+    bool cursor_moved = !gpoint_equal(&s_cursor_position, &s_drawn_cursor_position);
+    if (cursor_moved) {
+        /* only the small cursor layer is moved, its contents never change */
+        layer_set_frame(s_cursor_layer, get_rect_for_cursor());
+        s_drawn_cursor_position = s_cursor_position;
+    }
+    if (focus_changed) {
+        layer_mark_dirty(s_keypad_layer);
+    }
+    if (cursor_moved || focus_changed) {
+        ++s_redraws_performed;
+    } else {
+        ++s_redraws_skipped;
+    }
 }
 
 static void init() {
@@ -735,12 +1205,21 @@ static void init() {
     });
     window_stack_push(s_main_window, true);
 
+    // Create the stack Window, shown on demand
+    s_stack_window = window_create();
+    window_set_window_handlers(s_stack_window, (WindowHandlers) {
+        .load = stack_window_load,
+        .unload = stack_window_unload
+    });
+
+    cursor_axis_set(&s_cursor_x, s_cursor_position.x);
+    cursor_axis_set(&s_cursor_y, s_cursor_position.y);
+
     // Subscribe to the accelerometer data service
-    int num_samples = 1;
-    accel_data_service_subscribe(num_samples, read_accel_and_move_cursor_callback);
+    accel_data_service_subscribe(ACCEL_BATCH_SIZE, read_accel_and_move_cursor_callback);
 
     // Choose update rate
-    accel_service_set_sampling_rate(ACCEL_SAMPLING_25HZ);
+    accel_service_set_sampling_rate(ACCEL_SAMPLING_RATE);
 
     light_enable(true);
 }
@@ -748,9 +1227,22 @@ static void init() {
 static void deinit() {
     // Destroy main Window
     window_destroy(s_main_window);
+    window_destroy(s_stack_window);
 
     accel_data_service_unsubscribe();
 
+    APP_LOG(APP_LOG_LEVEL_INFO,
+            "accel: %lu/%lu batches, %lu/%lu samples (active/resting), %lu switches",
+            (unsigned long)s_cursor_activity.active_batches,
+            (unsigned long)s_cursor_activity.resting_batches,
+            (unsigned long)s_cursor_activity.active_samples,
+            (unsigned long)s_cursor_activity.resting_samples,
+            (unsigned long)s_cursor_activity.switches);
+    APP_LOG(APP_LOG_LEVEL_INFO,
+            "redraws: %lu performed, %lu skipped",
+            (unsigned long)s_redraws_performed,
+            (unsigned long)s_redraws_skipped);
+
     light_enable(false);
 }
 
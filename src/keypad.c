@@ -0,0 +1,112 @@
+/** @file keypad.c
+ *  @brief The keypad geometry and the hit-testing.
+ *  @author Wojciech 'vifon' Siewierski
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#include "keypad.h"
+
+#define KEYPAD_MARGIN_X 5
+#define KEYPAD_MARGIN_Y 4
+#define KEY_SEP_X 5
+#define KEY_SEP_Y 5
+#define KEY_HEIGHT 25
+
+/** The width available to the keys themselves. */
+#define KEYPAD_USABLE_WIDTH \
+    (KEYPAD_WIDTH - KEY_SEP_X * (KEYPAD_COLUMNS - 1) - KEYPAD_MARGIN_X * 2)
+
+/** The key width is not a whole number of pixels, so the columns are
+ *  laid out in the units of 1 / (2 * KEYPAD_COLUMNS) pixel. */
+#define KEY_SUBPIXELS (2 * KEYPAD_COLUMNS)
+
+/** The key width in @ref KEY_SUBPIXELS, 0.5 is added for the proper
+ *  rounding. */
+#define KEY_WIDTH_SUBPIXELS (2 * KEYPAD_USABLE_WIDTH + KEYPAD_COLUMNS)
+
+/** The distance between the columns in @ref KEY_SUBPIXELS. */
+#define KEY_STRIDE_X_SUBPIXELS (KEY_WIDTH_SUBPIXELS + KEY_SEP_X * KEY_SUBPIXELS)
+
+/** The distance between the rows. */
+#define KEY_STRIDE_Y (KEY_HEIGHT + KEY_SEP_Y)
+
+#define KEY_COLUMN_X(column) \
+    ((column) * KEY_STRIDE_X_SUBPIXELS / KEY_SUBPIXELS + KEYPAD_MARGIN_X)
+#define KEY_ROW_Y(row) ((row) * KEY_STRIDE_Y + KEYPAD_MARGIN_Y)
+
+#define KEY_RECT(key)                                           \
+    {KEY_COLUMN_X((key) % KEYPAD_COLUMNS),                      \
+     KEY_ROW_Y((key) / KEYPAD_COLUMNS),                         \
+     KEY_WIDTH_SUBPIXELS / KEY_SUBPIXELS,                       \
+     KEY_HEIGHT}
+
+/** The bounds of all the keys, computed by the preprocessor. */
+static const KeypadRect s_key_rects[KEY_COUNT] =
+{KEY_RECT(0),  KEY_RECT(1),  KEY_RECT(2),  KEY_RECT(3),
+ KEY_RECT(4),  KEY_RECT(5),  KEY_RECT(6),  KEY_RECT(7),
+ KEY_RECT(8),  KEY_RECT(9),  KEY_RECT(10), KEY_RECT(11),
+ KEY_RECT(12), KEY_RECT(13), KEY_RECT(14), KEY_RECT(15)};
+
+/** Get the bounds of a key.
+ *
+ *  @param key Index of the key, less than @ref KEY_COUNT.
+ *
+ *  @return The bounds relative to the upper left corner of the keypad.
+ */
+const KeypadRect* keypad_key_rect(int key)
+{
+    return &s_key_rects[key];
+}
+
+/** Find the key containing a point, without searching all of them.
+ *
+ *  The row and the column are computed directly. The column estimate
+ *  can be one too low because of the rounded column positions, the
+ *  table is checked for that.
+ *
+ *  @param x The point relative to the upper left corner of the keypad.
+ *  @param y @copydoc x
+ *
+ *  @return Index of the key, -1 for the margins and the gaps between
+ *  the keys.
+ */
+int keypad_key_at(int x, int y)
+{
+    if (x < KEYPAD_MARGIN_X || y < KEYPAD_MARGIN_Y) {
+        return -1;
+    }
+
+    int column = (x - KEYPAD_MARGIN_X) * KEY_SUBPIXELS / KEY_STRIDE_X_SUBPIXELS;
+    const int row = (y - KEYPAD_MARGIN_Y) / KEY_STRIDE_Y;
+    if (column >= KEYPAD_COLUMNS || row >= KEYPAD_ROWS) {
+        return -1;
+    }
+    if (column + 1 < KEYPAD_COLUMNS && x >= s_key_rects[column + 1].x) {
+        ++column;
+    }
+
+    const int key = row * KEYPAD_COLUMNS + column;
+    const KeypadRect* rect = &s_key_rects[key];
+    if (x >= rect->x + rect->w || y >= rect->y + rect->h) {
+        return -1;
+    }
+    return key;
+}
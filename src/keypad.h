@@ -0,0 +1,53 @@
+/** @file keypad.h
+ *  @brief The keypad geometry and the hit-testing.
+ *  @author Wojciech 'vifon' Siewierski
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#ifndef _h_KEYPAD_
+#define _h_KEYPAD_
+
+#include <stdint.h>
+
+/** Number of the key columns. */
+#define KEYPAD_COLUMNS 4
+/** Number of the key rows. */
+#define KEYPAD_ROWS 4
+
+/** Number of keys on the calculator keypad. */
+#define KEY_COUNT ((KEYPAD_COLUMNS) * (KEYPAD_ROWS))
+
+/** Width of the keypad layer. */
+#define KEYPAD_WIDTH 144
+
+/** The bounds of a key relative to the upper left corner of the
+ *  keypad layer. */
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+} KeypadRect;
+
+const KeypadRect* keypad_key_rect(int key);
+int keypad_key_at(int x, int y);
+
+#endif
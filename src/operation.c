@@ -0,0 +1,75 @@
+/** @file operation.c
+ *  @brief The arithmetic operations of the calculator keys.
+ *  @author Wojciech 'vifon' Siewierski
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#include "operation.h"
+
+/** Perform an arithmetic operation on two numbers.
+ *
+ *  @param op The operator of the key: '+', '-', '*', '/' or '^'. The
+ *  exponent of '^' is the integral part of @p rhs.
+ *  @param lhs
+ *  @param rhs
+ *  @param[out] result The result, set only if the operation succeeded.
+ *
+ *  @return @ref OPERATION_DIVISION_BY_ZERO for a division by 0 or 0
+ *  raised to a negative power, @ref OPERATION_OVERFLOW if the result
+ *  is out of range and @ref OPERATION_OK otherwise.
+ */
+OperationStatus operation_perform(char op, CALC_TYPE lhs, CALC_TYPE rhs, CALC_TYPE* result)
+{
+    bool overflow = false;
+    CALC_TYPE value;
+
+    switch (op) {
+    case '+':
+        value = ADD(lhs, rhs, &overflow);
+        break;
+    case '-':
+        value = SUBT(lhs, rhs, &overflow);
+        break;
+    case '*':
+        value = MULT(lhs, rhs, &overflow);
+        break;
+    case '/':
+        value = DIV(lhs, rhs, &overflow);
+        break;
+    case '^':
+        value = POW(lhs, TO_INT(rhs), &overflow);
+        break;
+    default:
+        value = 0;
+        break;
+    }
+
+    if (overflow) {
+        bool division_by_zero =
+            (op == '/' && rhs == 0) ||
+            (op == '^' && lhs == 0 && TO_INT(rhs) < 0);
+
+        return division_by_zero ? OPERATION_DIVISION_BY_ZERO : OPERATION_OVERFLOW;
+    }
+
+    *result = value;
+    return OPERATION_OK;
+}
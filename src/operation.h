@@ -1,5 +1,5 @@
-/** @file utility.h
- *  @brief Various utility functions.
+/** @file operation.h
+ *  @brief The arithmetic operations of the calculator keys.
  *  @author Wojciech 'vifon' Siewierski
  */
 
@@ -22,40 +22,22 @@
 /* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
 /***********************************************************************************/
 
-#ifndef _h_UTILITY_
-#define _h_UTILITY_
+#ifndef _h_OPERATION_
+#define _h_OPERATION_
 
 #include "config.h"
 
-/** Convert a string to integer.
- *
- *  @param str String to convert.
- *  @param[out] endptr If non-NULL, set to the first invalid character.
- *  @param maxnum Max number of digits to read. Pass -1 for unlimited.
- *
- *  @return The converted integer.
- */
-int str_to_int(const char *str, char **endptr, int maxnum) {
-    int result = 0;
-
-    int sign = 1;
-    if (*str == '-') {
-        ++str;
-        sign = -1;
-    }
-
-    while (*str >= '0' && *str <= '9' && maxnum-- != 0) {
-        result *= 10;
-        result += *str++ - '0';
-    }
+#include "fixed.h"
+#include "fixed64.h"
+#include "qfixed.h"
 
-    /* save the position of the first invalid character */
-    if (endptr != NULL) {
-        /* http://stackoverflow.com/questions/993700/are-strtol-strtod-unsafe */
-        *endptr = (char*)str;
-    }
+/** The outcome of @ref operation_perform. */
+typedef enum {
+    OPERATION_OK,
+    OPERATION_OVERFLOW,
+    OPERATION_DIVISION_BY_ZERO
+} OperationStatus;
 
-    return sign * result;
-}
+OperationStatus operation_perform(char op, CALC_TYPE lhs, CALC_TYPE rhs, CALC_TYPE* result);
 
 #endif
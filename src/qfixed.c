@@ -0,0 +1,496 @@
+/** @file qfixed.c
+ *  @brief A binary (Q format) fixed point numbers implementation.
+ *  @author Wojciech 'vifon' Siewierski
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#include "qfixed.h"
+
+#include <string.h>
+
+#include "calc_common.h"
+
+/** The number of the decimal places the parser takes into account
+ *  when rounding to the nearest binary fraction. */
+#define PARSED_FRACTIONAL_DIGITS 9
+
+/** 10 to the power of @ref PARSED_FRACTIONAL_DIGITS. */
+#define PARSED_FRACTIONAL_SCALE 1000000000ULL
+
+/** The absolute value of a binary fixed point number.
+ *
+ *  @param n
+ *
+ *  @return |n|, correct for @p INT32_MIN too.
+ */
+static inline uint32_t magnitude(qfixed n)
+{
+    return n < 0 ? 0u - (uint32_t)n : (uint32_t)n;
+}
+
+/** Apply a sign to a magnitude known to be in range.
+ *
+ *  @param n
+ *  @param negative
+ *
+ *  @return @p n or @p -n.
+ */
+static inline qfixed with_sign(uint32_t n, bool negative)
+{
+    return negative ? -(qfixed)n : (qfixed)n;
+}
+
+/** Round a non-negative number to the nearest multiple of
+ *  10^-QFIXED_FRACTIONAL_DIGITS.
+ *
+ *  @param n
+ *
+ *  @return The rounded number scaled by @ref QFIXED_DECIMAL_SCALE.
+ */
+static inline uint32_t to_decimal(uint32_t n)
+{
+    return (uint32_t)(((uint64_t)n * QFIXED_DECIMAL_SCALE + QFIXED_ONE / 2)
+                      >> QFIXED_FRACTIONAL_BITS);
+}
+
+/** The reverse of @ref to_decimal, rounding to the nearest binary
+ *  fraction. The round trip is exact for any result of @ref
+ *  to_decimal.
+ *
+ *  @param n A number scaled by @ref QFIXED_DECIMAL_SCALE.
+ *
+ *  @return The binary fixed point number, possibly out of range.
+ */
+static inline uint64_t from_decimal(uint64_t n)
+{
+    return ((n << QFIXED_FRACTIONAL_BITS) + QFIXED_DECIMAL_SCALE / 2)
+        / QFIXED_DECIMAL_SCALE;
+}
+
+/** Sum two binary fixed point numbers.
+ *
+ *  @param lhs
+ *  @param rhs
+ *  @param[out] overflow Indicate whether the addition would
+ *  result in an overflow. If the initial value is @p true, it will
+ *  stay @p true. The returned value is unspecified if it is true.
+ *
+ *  @return The result.
+ */
+qfixed qfixed_add(qfixed lhs, qfixed rhs, bool* overflow)
+{
+    // If both arguments have the same sign...
+    if ((rhs > 0) == (lhs > 0)) {
+        // ...check for the overflow.
+        *overflow = *overflow || magnitude(lhs) > QFIXED_MAX - magnitude(rhs);
+    }
+
+    if (*overflow) {
+        return lhs;
+    }
+
+    return lhs + rhs;
+}
+
+/** Subtract two binary fixed point numbers.
+ *
+ *  @param lhs
+ *  @param rhs
+ *  @param[out] overflow Indicate whether the subtraction would
+ *  result in an overflow. If the initial value is @p true, it will
+ *  stay @p true. The returned value is unspecified if it is true.
+ *
+ *  @return The result.
+ */
+qfixed qfixed_subt(qfixed lhs, qfixed rhs, bool* overflow)
+{
+    return qfixed_add(lhs, -rhs, overflow);
+}
+
+/** Multiply two binary fixed point numbers, rounding to the nearest.
+ *
+ *  The product is rescaled with a shift instead of a division.
+ *
+ *  @param lhs
+ *  @param rhs
+ *  @param[out] overflow Indicate whether the multiplication would
+ *  result in an overflow. If the initial value is @p true, it will
+ *  stay @p true. The returned value is unspecified if it is true.
+ *
+ *  @return The result.
+ */
+qfixed qfixed_mult(qfixed lhs, qfixed rhs, bool* overflow)
+{
+    uint64_t product = (uint64_t)magnitude(lhs) * magnitude(rhs);
+    uint64_t result = (product + QFIXED_ONE / 2) >> QFIXED_FRACTIONAL_BITS;
+
+    *overflow = *overflow || result > (uint64_t)QFIXED_MAX;
+
+    if (*overflow) {
+        return lhs;
+    }
+
+    return with_sign((uint32_t)result, (lhs < 0) != (rhs < 0));
+}
+
+/** Divide two binary fixed point numbers, rounding to the nearest.
+ *
+ *  The dividend is rescaled with a shift instead of a multiplication.
+ *
+ *  @param lhs
+ *  @param rhs
+ *  @param[out] overflow Indicate whether the division would result
+ *  in an overflow or @p rhs is 0. If the initial value is @p true,
+ *  it will stay @p true. The returned value is unspecified if it is
+ *  true.
+ *
+ *  @return The result.
+ */
+qfixed qfixed_div(qfixed lhs, qfixed rhs, bool* overflow)
+{
+    if (rhs == 0) {
+        *overflow = true;
+        return lhs;
+    }
+
+    uint32_t divisor = magnitude(rhs);
+    uint64_t result =
+        (((uint64_t)magnitude(lhs) << QFIXED_FRACTIONAL_BITS) + divisor / 2) / divisor;
+
+    *overflow = *overflow || result > (uint64_t)QFIXED_MAX;
+
+    if (*overflow) {
+        return lhs;
+    }
+
+    return with_sign((uint32_t)result, (lhs < 0) != (rhs < 0));
+}
+
+/** Create the textual representation of the binary fixed point
+ *  number and return its length.
+ *
+ *  The number is rounded to the nearest one with @ref
+ *  QFIXED_FRACTIONAL_DIGITS decimal places, so for example the
+ *  binary approximation of 0.1 is shown as 0.1 again. The trailing
+ *  zeros of the fractional part are omitted and so is the fractional
+ *  part equal to 0.
+ *
+ *  @param n A number to represent.
+ *  @param buffer A buffer to store the representation.
+ *  @param size Size of @p buffer. The representation is truncated
+ *  to fit in it, just like with <tt>snprintf(3)</tt>.
+ *
+ *  @return The number of characters stored in @p buffer, not
+ *  counting the terminating null character.
+ */
+size_t qfixed_to_str(qfixed n, char* buffer, size_t size)
+{
+    if (size == 0) {
+        return 0;
+    }
+
+    uint32_t decimal = to_decimal(magnitude(n));
+    uint32_t integral_part = decimal / QFIXED_DECIMAL_SCALE;
+    uint32_t fractional_part = decimal % QFIXED_DECIMAL_SCALE;
+
+    if (integral_part > QFIXED_INTEGRAL_MAX) {
+        /* Rounded up past the range. Round down instead, so that the
+         * representation can be parsed back. */
+        integral_part = QFIXED_INTEGRAL_MAX;
+        fractional_part = QFIXED_DECIMAL_SCALE - 1;
+    }
+
+    size_t integral_digits = calc_count_digits(integral_part);
+    size_t fractional_digits = 0;
+
+    if (fractional_part != 0) {
+        /* Remove the trailing zeros. */
+        fractional_digits = QFIXED_FRACTIONAL_DIGITS;
+        while (fractional_part % 10 == 0) {
+            fractional_part /= 10;
+            --fractional_digits;
+        }
+    }
+
+    /* The tiny negative numbers are shown as 0, not -0. */
+    bool negative = n < 0 && decimal != 0;
+
+    size_t length = negative + integral_digits;
+    if (fractional_digits != 0) {
+        length += 1 + fractional_digits;
+    }
+
+    if (length >= size) {
+        /* Rare enough to just represent it in full elsewhere. */
+        char full[QFIXED_REPR_SIZE];
+        qfixed_to_str(n, full, sizeof(full));
+        memcpy(buffer, full, size - 1);
+        buffer[size-1] = '\0';
+        return size - 1;
+    }
+
+    /* Fill the buffer from the end. */
+    char* output = buffer + length;
+    *output = '\0';
+
+    if (fractional_digits != 0) {
+        output = calc_write_digits_backwards(output, fractional_part, fractional_digits);
+        *--output = '.';
+    }
+
+    output = calc_write_digits_backwards(output, integral_part, integral_digits);
+
+    if (negative) {
+        *--output = '-';
+    }
+
+    return length;
+}
+
+/** Create the textual representation of the binary fixed point number.
+ *
+ *  @param n A number to represent.
+ *  @param buffer A buffer to store the representation.
+ *  @param size Size of @p buffer.
+ *
+ *  @return A pointer to the @p buffer parameter.
+ *
+ *  @see qfixed_to_str
+ */
+char* qfixed_repr(qfixed n, char* buffer, size_t size)
+{
+    qfixed_to_str(n, buffer, size);
+    return buffer;
+}
+
+/** Convert at most @p length characters of a string to a binary
+ *  fixed point number in a single pass.
+ *
+ *  Accepts an optional minus sign, the integral part and optionally
+ *  a decimal point followed by the fractional part. The fractional
+ *  part is rounded to the nearest binary fraction. Only its first
+ *  @ref PARSED_FRACTIONAL_DIGITS digits are taken into account, the
+ *  rest is consumed but ignored.
+ *
+ *  @param str String to convert. Doesn't need to be null-terminated
+ *  if @p length is given.
+ *  @param length Max number of characters to read. Pass -1 for
+ *  unlimited (the conversion stops at the null character anyway).
+ *  @param[out] endptr If non-NULL, set to the first unparsed character.
+ *  @param[out] overflow Indicate whether the conversion would
+ *  result in an overflow. If the initial value is @p true, it will
+ *  stay @p true. The returned value is unspecified if it is true.
+ *
+ *  @return The converted fixed point number.
+ */
+qfixed strn_to_qfixed(const char* str, size_t length, char** endptr, bool* overflow)
+{
+    bool negative = false;
+    if (length > 0 && *str == '-') {
+        negative = true;
+        ++str;
+        --length;
+    }
+
+    uint32_t integral_part = 0;
+    bool too_big = false;
+
+    for (; length > 0 && *str >= '0' && *str <= '9'; ++str, --length) {
+        uint32_t digit = *str - '0';
+        if (integral_part > (QFIXED_INTEGRAL_MAX - digit) / 10) {
+            too_big = true;
+        } else {
+            integral_part = integral_part * 10 + digit;
+        }
+    }
+
+    uint32_t fractional_part = 0;
+    int fractional_digits = 0;
+
+    if (length > 0 && *str == '.') {
+        ++str;
+        --length;
+
+        for (; length > 0 && *str >= '0' && *str <= '9'; ++str, --length) {
+            if (fractional_digits < PARSED_FRACTIONAL_DIGITS) {
+                fractional_part = fractional_part * 10 + (*str - '0');
+                ++fractional_digits;
+            }
+        }
+    }
+
+    for (; fractional_digits < PARSED_FRACTIONAL_DIGITS; ++fractional_digits) {
+        fractional_part *= 10;
+    }
+
+    /* save the position of the first invalid character */
+    if (endptr != NULL) {
+        *endptr = (char*)str;
+    }
+
+    /* Round to the nearest binary fraction, possibly up to 1. */
+    uint64_t result = ((uint64_t)integral_part << QFIXED_FRACTIONAL_BITS)
+        + ((((uint64_t)fractional_part << QFIXED_FRACTIONAL_BITS) + PARSED_FRACTIONAL_SCALE / 2)
+           / PARSED_FRACTIONAL_SCALE);
+
+    *overflow = *overflow || too_big || result > (uint64_t)QFIXED_MAX;
+
+    if (*overflow) {
+        return 0;
+    }
+
+    return with_sign((uint32_t)result, negative);
+}
+
+/** Convert a null-terminated string to a binary fixed point number.
+ *
+ *  @param str String to convert.
+ *  @param[out] overflow Indicate whether the conversion would
+ *  result in an overflow. If the initial value is @p true, it will
+ *  stay @p true. The returned value is unspecified if it is true.
+ *
+ *  @return The converted fixed point number.
+ *
+ *  @see strn_to_qfixed
+ */
+qfixed str_to_qfixed(const char* str, bool* overflow)
+{
+    return strn_to_qfixed(str, (size_t)-1, NULL, overflow);
+}
+
+/** The place values of the consecutive fractional digits, scaled by
+ *  @ref QFIXED_DECIMAL_SCALE. */
+static const uint32_t s_fractional_places[] = {
+    QFIXED_DECIMAL_SCALE / 10,
+    QFIXED_DECIMAL_SCALE / 100,
+    QFIXED_DECIMAL_SCALE / 1000,
+    QFIXED_DECIMAL_SCALE / 10000,
+};
+
+/** Append a digit to the decimal notation of a number.
+ *
+ *  The digits are accumulated on the decimal grid of @ref
+ *  QFIXED_FRACTIONAL_DIGITS places, so typing a number gives the
+ *  same result as parsing it, without any rounding errors adding up.
+ *
+ *  @param n A non-negative number being edited.
+ *  @param digit The appended digit (0-9).
+ *  @param fractional_digits The number of the digits already
+ *  present after the decimal point or -1 if it is absent.
+ *  @param[out] overflow Indicate whether the result would overflow.
+ *  If the initial value is @p true, it will stay @p true. The
+ *  returned value is unspecified if it is true.
+ *
+ *  @return The updated number. The digits beyond @ref
+ *  QFIXED_FRACTIONAL_DIGITS are ignored.
+ *
+ *  @see fixed_append_digit
+ */
+qfixed qfixed_append_digit(qfixed n, int digit, int fractional_digits, bool* overflow)
+{
+    if (fractional_digits >= QFIXED_FRACTIONAL_DIGITS) {
+        return n;
+    }
+
+    uint64_t decimal = to_decimal(n);
+    if (fractional_digits < 0) {
+        decimal = decimal * 10 + (uint64_t)digit * QFIXED_DECIMAL_SCALE;
+    } else {
+        decimal += digit * s_fractional_places[fractional_digits];
+    }
+
+    uint64_t result = from_decimal(decimal);
+
+    *overflow = *overflow || result > (uint64_t)QFIXED_MAX;
+
+    if (*overflow) {
+        return n;
+    }
+
+    return (qfixed)result;
+}
+
+/** Remove the last digit from the decimal notation of a number.
+ *
+ *  The reverse of @ref qfixed_append_digit.
+ *
+ *  @param n A non-negative number being edited.
+ *  @param digit The removed digit (0-9).
+ *  @param fractional_digits The number of the digits after the
+ *  decimal point that will remain after the removal or -1 if the
+ *  removed digit is a part of the integral part.
+ *
+ *  @return The updated number.
+ */
+qfixed qfixed_remove_digit(qfixed n, int digit, int fractional_digits)
+{
+    if (fractional_digits >= QFIXED_FRACTIONAL_DIGITS) {
+        return n;
+    }
+
+    uint32_t decimal = to_decimal(n);
+    if (fractional_digits < 0) {
+        decimal = (decimal - digit * QFIXED_DECIMAL_SCALE) / 10;
+    } else {
+        decimal -= digit * s_fractional_places[fractional_digits];
+    }
+
+    return (qfixed)from_decimal(decimal);
+}
+
+/** Convert the binary fixed point value to a regular integer.
+ *
+ *  @param n
+ *
+ *  @return The integral part of the fixed point number.
+ */
+int qfixed_to_int(qfixed n)
+{
+    return with_sign(magnitude(n) >> QFIXED_FRACTIONAL_BITS, n < 0);
+}
+
+/** Convert the integer to a binary fixed point value.
+ *
+ *  @param n
+ *
+ *  @return The converted fixed point number.
+ */
+qfixed int_to_qfixed(int n)
+{
+    return n * QFIXED_ONE;
+}
+
+/** An implementation of the <tt>pow(3)</tt> standard function for
+ *  binary fixed point numbers using exponentiation by squaring.
+ *
+ *  @param base
+ *  @param exponent
+ *  @param[out] overflow Indicate whether the exponentiation would
+ *  result in an overflow. If the initial value is @p true, it will
+ *  stay @p true. The returned value is unspecified if it is true.
+ *
+ *  @return The exponentiation result.
+ *
+ *  @note The exponent is an integer, not a fixed point number.
+ *
+ *  @see fixed_pow
+ */
+DEFINE_POW(qfixed, QFIXED_ONE, QFIXED_MAX)
@@ -0,0 +1,88 @@
+/** @file qfixed.h
+ *  @brief A binary (Q format) fixed point numbers implementation.
+ *  @author Wojciech 'vifon' Siewierski
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#ifndef _h_QFIXED_
+#define _h_QFIXED_
+
+#include "config.h"
+
+/* Do not include pebble.h when compiling the unittests. */
+#ifndef __cplusplus
+#   include <pebble.h>             /* for bool */
+#endif
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/** The underlying binary fixed point representation. */
+typedef int32_t qfixed;
+
+/** @def QFIXED_FRACTIONAL_DIGITS
+ *  Number of the decimal places shown and accepted, as many as the
+ *  binary fraction of @ref QFIXED_FRACTIONAL_BITS can always tell
+ *  apart: the step of 2^-bits is less than half of 10^-digits.
+ *
+ *  @def QFIXED_DECIMAL_SCALE
+ *  10 to the power of @ref QFIXED_FRACTIONAL_DIGITS.
+ */
+#if QFIXED_FRACTIONAL_BITS == 16
+#   define QFIXED_FRACTIONAL_DIGITS 4
+#   define QFIXED_DECIMAL_SCALE 10000
+#elif QFIXED_FRACTIONAL_BITS == 12
+#   define QFIXED_FRACTIONAL_DIGITS 3
+#   define QFIXED_DECIMAL_SCALE 1000
+#else
+#   error "QFIXED_FRACTIONAL_BITS must be either 16 or 12."
+#endif
+
+/** The representation of 1, the scaling factor. */
+#define QFIXED_ONE (1 << QFIXED_FRACTIONAL_BITS)
+
+/** Maximum representable value. */
+static const qfixed QFIXED_MAX = INT32_MAX;
+
+/** Maximum integral part of a representable value. */
+#define QFIXED_INTEGRAL_MAX (INT32_MAX >> QFIXED_FRACTIONAL_BITS)
+
+/** Buffer size sufficient for the textual representation of any
+ *  binary fixed point number, including the terminating null
+ *  character. */
+#define QFIXED_REPR_SIZE 16
+
+qfixed qfixed_add(qfixed lhs, qfixed rhs, bool* overflow);
+qfixed qfixed_subt(qfixed lhs, qfixed rhs, bool* overflow);
+qfixed qfixed_mult(qfixed lhs, qfixed rhs, bool* overflow);
+qfixed qfixed_div(qfixed lhs, qfixed rhs, bool* overflow);
+char* qfixed_repr(qfixed n, char* buffer, size_t size);
+size_t qfixed_to_str(qfixed n, char* buffer, size_t size);
+qfixed strn_to_qfixed(const char* str, size_t length, char** endptr, bool* overflow);
+qfixed str_to_qfixed(const char* str, bool* overflow);
+qfixed qfixed_append_digit(qfixed n, int digit, int fractional_digits, bool* overflow);
+qfixed qfixed_remove_digit(qfixed n, int digit, int fractional_digits);
+int qfixed_to_int(qfixed n);
+qfixed int_to_qfixed(int n);
+qfixed qfixed_pow(qfixed base, int exponent, bool* overflow);
+
+#endif
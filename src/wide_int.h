@@ -0,0 +1,149 @@
+/** @file wide_int.h
+ *  @brief 128-bit intermediates for the 64-bit arithmetic.
+ *  @author Wojciech 'vifon' Siewierski
+ *
+ *  The host compilers provide a native 128-bit integer type. The ARM
+ *  toolchain doesn't, so there the same operations are built from the
+ *  32-bit halves. Define @p WIDE_INT_PORTABLE to use the portable
+ *  versions everywhere.
+ */
+
+/***********************************************************************************/
+/* Copyright (C) 2015 Wojciech Siewierski <wojciech dot siewierski at onet dot pl> */
+/*                                                                                 */
+/* Author: Wojciech Siewierski <wojciech dot siewierski at onet dot pl>            */
+/*                                                                                 */
+/* This program is free software; you can redistribute it and/or                   */
+/* modify it under the terms of the GNU General Public License                     */
+/* as published by the Free Software Foundation; either version 3                  */
+/* of the License, or (at your option) any later version.                          */
+/*                                                                                 */
+/* This program is distributed in the hope that it will be useful,                 */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of                  */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                   */
+/* GNU General Public License for more details.                                    */
+/*                                                                                 */
+/* You should have received a copy of the GNU General Public License               */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.            */
+/***********************************************************************************/
+
+#ifndef _h_WIDE_INT_
+#define _h_WIDE_INT_
+
+#include <stdint.h>
+
+#if defined(__SIZEOF_INT128__) && !defined(WIDE_INT_PORTABLE)
+#   define WIDE_INT_NATIVE 1
+#else
+#   define WIDE_INT_NATIVE 0
+#endif
+
+/** Multiply two 64-bit numbers into a 128-bit result.
+ *
+ *  @param a
+ *  @param b
+ *  @param[out] hi The high 64 bits of the product.
+ *
+ *  @return The low 64 bits of the product.
+ */
+static inline uint64_t wide_mul_u64(uint64_t a, uint64_t b, uint64_t* hi)
+{
+#if WIDE_INT_NATIVE
+    unsigned __int128 product = (unsigned __int128)a * b;
+    *hi = (uint64_t)(product >> 64);
+    return (uint64_t)product;
+#else
+    /* Schoolbook multiplication on the 32-bit halves. */
+    uint64_t a_lo = (uint32_t)a;
+    uint64_t a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b;
+    uint64_t b_hi = b >> 32;
+
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t hi_hi = a_hi * b_hi;
+
+    uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+
+    *hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    return (cross << 32) | (uint32_t)lo_lo;
+#endif
+}
+
+/** The high 64 bits of the 128-bit product of two 64-bit numbers.
+ *
+ *  @param a
+ *  @param b
+ *
+ *  @return <tt>(a * b) >> 64</tt>
+ */
+static inline uint64_t wide_umulh64(uint64_t a, uint64_t b)
+{
+    uint64_t hi;
+    wide_mul_u64(a, b, &hi);
+    return hi;
+}
+
+/** Divide a 128-bit number by a 64-bit one.
+ *
+ *  @param hi The high 64 bits of the dividend. Must be less than @p d
+ *  so the quotient fits in 64 bits.
+ *  @param lo The low 64 bits of the dividend.
+ *  @param d The divisor.
+ *
+ *  @return The quotient.
+ */
+static inline uint64_t wide_div_u64(uint64_t hi, uint64_t lo, uint64_t d)
+{
+#if WIDE_INT_NATIVE
+    return (uint64_t)((((unsigned __int128)hi << 64) | lo) / d);
+#else
+    /* Shift-subtract long division. hi holds the running remainder
+     * and lo collects the quotient bits as the dividend shifts out. */
+    int i;
+    for (i = 0; i < 64; ++i) {
+        uint64_t carry = hi >> 63;
+        hi = (hi << 1) | (lo >> 63);
+        lo <<= 1;
+        if (carry || hi >= d) {
+            hi -= d;
+            lo |= 1;
+        }
+    }
+    return lo;
+#endif
+}
+
+/** Divide a 128-bit number by a small 32-bit one.
+ *
+ *  Cheaper than @ref wide_div_u64 without the native 128-bit type, as
+ *  it needs only eight 32-bit divisions.
+ *
+ *  @param hi The high 64 bits of the dividend. Must be less than @p d
+ *  so the quotient fits in 64 bits.
+ *  @param lo The low 64 bits of the dividend.
+ *  @param d The divisor, less than 2^24.
+ *
+ *  @return The quotient.
+ */
+static inline uint64_t wide_div_small(uint64_t hi, uint64_t lo, uint32_t d)
+{
+#if WIDE_INT_NATIVE
+    return (uint64_t)((((unsigned __int128)hi << 64) | lo) / d);
+#else
+    /* Long division byte by byte: the remainder stays below 2^24, so
+     * with the next byte appended it still fits in 32 bits. */
+    uint32_t remainder = (uint32_t)hi;
+    uint64_t quotient = 0;
+    int shift;
+    for (shift = 56; shift >= 0; shift -= 8) {
+        uint32_t current = (remainder << 8) | (uint32_t)((lo >> shift) & 0xFF);
+        quotient = (quotient << 8) | (current / d);
+        remainder = current % d;
+    }
+    return quotient;
+#endif
+}
+
+#endif
@@ -0,0 +1,421 @@
+// File: benchmarks.cpp
+//
+// Microbenchmarks of the fixed point routines. Hidden from the
+// default test run, use: ./unittests "[benchmark]"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "../src/cursor.h"
+#include "../src/fixed.h"
+#include "../src/fixed64.h"
+#include "../src/fixed_batch.h"
+#include "../src/qfixed.h"
+
+namespace {
+
+/** Written to by the benchmarks so the measured work cannot be
+ *  optimized away. */
+volatile long long sink;
+
+/** A fixed pseudorandom sample of the operands. */
+std::vector<fixed> sample_operands(size_t count, int shift)
+{
+    std::vector<fixed> operands(count);
+    unsigned int seed = 12345;
+    for (fixed& n : operands) {
+        seed = seed * 1103515245 + 12345;
+        n = (fixed)seed >> shift;
+    }
+    return operands;
+}
+
+/** Measure the average time of a single call of @p f. */
+template <typename T, typename F>
+double ns_per_op(const std::vector<T>& operands, F f)
+{
+    const int rounds = 100;
+    long long accumulator = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (size_t i = 0; i + 1 < operands.size(); ++i) {
+            accumulator += f(operands[i], operands[i+1]);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    sink = accumulator;
+    return std::chrono::duration<double, std::nano>(end - start).count()
+        / (rounds * (operands.size() - 1));
+}
+
+/* The reference implementations are the plain divisions by the
+ * constant scale, left to the compiler to optimize. They are kept
+ * out of line to be called the same way as the measured functions
+ * from fixed.c. */
+
+__attribute__((noinline))
+int reference_to_int(fixed n)
+{
+    return n / FIXED_SCALE;
+}
+
+__attribute__((noinline))
+fixed reference_mult(fixed lhs, fixed rhs)
+{
+    return (fixed)((long long)lhs * rhs / FIXED_SCALE);
+}
+
+__attribute__((noinline))
+fixed64 reference_mult64(fixed64 lhs, fixed64 rhs)
+{
+    return (fixed64)((__int128)lhs * rhs / FIXED64_SCALE);
+}
+
+__attribute__((noinline))
+fixed64 reference_div64(fixed64 lhs, fixed64 rhs)
+{
+    return (fixed64)((__int128)lhs * FIXED64_SCALE / rhs);
+}
+
+__attribute__((noinline))
+int reference_repr(fixed n, char* buffer, size_t size)
+{
+    return std::snprintf(buffer, size, "%d.%0*d",
+                         n / FIXED_SCALE, FIXED_FRACTIONAL_DIGITS,
+                         abs(n % FIXED_SCALE));
+}
+
+/** The floating point cursor motion replaced by cursor_axis_move(). */
+__attribute__((noinline))
+int reference_move_axis(int position, int tilt, int pull, int limit)
+{
+    const float ACCEL_MAX = 4000.f;
+    int16_t coordinate = position;
+    coordinate += tilt * (limit / ACCEL_MAX) + pull;
+    if (coordinate < 0) {
+        coordinate = 0;
+    } else if (coordinate > limit) {
+        coordinate = limit;
+    }
+    return coordinate;
+}
+
+/** The operations of perform_operation() in a fixed rotation, with
+ *  the same operands for every backend. */
+template <typename T, typename Add, typename Subt, typename Mult, typename Div, typename Pow>
+T operation_mix(T lhs, T rhs, Add add, Subt subt, Mult mult, Div div, Pow pow)
+{
+    static unsigned int op = 0;
+    bool overflow = false;
+    switch (op++ % 5) {
+    case 0:  return add(lhs, rhs, &overflow);
+    case 1:  return subt(lhs, rhs, &overflow);
+    case 2:  return mult(lhs, rhs, &overflow);
+    case 3:  return div(lhs, rhs | 1, &overflow);
+    default: return pow(lhs, rhs & 3, &overflow);
+    }
+}
+
+void report(const char* name, double reference, double optimized)
+{
+    std::printf("%-24s %8.2f ns -> %8.2f ns (%.2fx)\n",
+                name, reference, optimized, reference / optimized);
+}
+
+/** Measure the average time per element of @p f processing whole
+ *  arrays. */
+template <typename F>
+double ns_per_element(size_t n, F f)
+{
+    const int rounds = 10;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        f();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count()
+        / (rounds * n);
+}
+
+/** Compare the scalar loop over a whole array with the batch function. */
+void report_batch(const char* name,
+                  fixed (*scalar)(fixed, fixed, bool*),
+                  size_t (*batch)(const fixed*, const fixed*, fixed*, size_t, uint32_t*),
+                  const std::vector<fixed>& lhs, const std::vector<fixed>& rhs)
+{
+    const size_t n = lhs.size();
+    std::vector<fixed> result(n);
+    std::vector<uint32_t> overflow(FIXED_MASK_WORDS(n));
+
+    double scalar_time = ns_per_element(n, [&]() {
+            size_t overflows = 0;
+            for (size_t i = 0; i < n; ++i) {
+                bool lane_overflow = false;
+                result[i] = scalar(lhs[i], rhs[i], &lane_overflow);
+                if (lane_overflow) {
+                    ++overflows;
+                }
+            }
+            sink = overflows + result[n / 2];
+        });
+
+    double batch_time = ns_per_element(n, [&]() {
+            sink = batch(lhs.data(), rhs.data(), result.data(), n, overflow.data())
+                + result[n / 2];
+        });
+
+    report(name, scalar_time, batch_time);
+}
+
+} // namespace
+
+TEST_CASE("scale division benchmark", "[.][benchmark]")
+{
+    const std::vector<fixed> operands = sample_operands(100000, 12);
+
+    report("fixed_to_int",
+           ns_per_op(operands, [](fixed lhs, fixed) {
+                   return reference_to_int(lhs);
+               }),
+           ns_per_op(operands, [](fixed lhs, fixed) {
+                   return fixed_to_int(lhs);
+               }));
+
+    report("fixed_mult",
+           ns_per_op(operands, [](fixed lhs, fixed rhs) {
+                   return reference_mult(lhs, rhs);
+               }),
+           ns_per_op(operands, [](fixed lhs, fixed rhs) {
+                   bool overflow = false;
+                   return fixed_mult(lhs, rhs, &overflow);
+               }));
+
+    char buffer[32];
+    report("fixed_repr",
+           ns_per_op(operands, [&buffer](fixed lhs, fixed) {
+                   return reference_repr(lhs, buffer, sizeof(buffer));
+               }),
+           ns_per_op(operands, [&buffer](fixed lhs, fixed) {
+                   return fixed_repr(lhs, buffer, sizeof(buffer))[0];
+               }));
+}
+
+TEST_CASE("64-bit arithmetic benchmark", "[.][benchmark]")
+{
+    const std::vector<fixed> operands = sample_operands(100000, 0);
+
+    report("fixed64_mult",
+           ns_per_op(operands, [](fixed lhs, fixed rhs) {
+                   return reference_mult64(lhs, rhs);
+               }),
+           ns_per_op(operands, [](fixed lhs, fixed rhs) {
+                   bool overflow = false;
+                   return fixed64_mult(lhs, rhs, &overflow);
+               }));
+
+    report("fixed64_div",
+           ns_per_op(operands, [](fixed lhs, fixed rhs) {
+                   return reference_div64(lhs, rhs | 1);
+               }),
+           ns_per_op(operands, [](fixed lhs, fixed rhs) {
+                   bool overflow = false;
+                   return fixed64_div(lhs, rhs | 1, &overflow);
+               }));
+}
+
+TEST_CASE("binary fixed point benchmark", "[.][benchmark]")
+{
+    /* The same numbers within +-100 with 2 decimal places in both
+     * representations. */
+    const std::vector<fixed> decimal = sample_operands(100000, 18);
+    std::vector<qfixed> binary(decimal.size());
+    for (size_t i = 0; i < decimal.size(); ++i) {
+        binary[i] = (qfixed)((long long)decimal[i] * QFIXED_ONE / FIXED_SCALE);
+    }
+
+    report("fixed -> qfixed mult",
+           ns_per_op(decimal, [](fixed lhs, fixed rhs) {
+                   bool overflow = false;
+                   return fixed_mult(lhs, rhs, &overflow);
+               }),
+           ns_per_op(binary, [](qfixed lhs, qfixed rhs) {
+                   bool overflow = false;
+                   return qfixed_mult(lhs, rhs, &overflow);
+               }));
+
+    report("fixed -> qfixed div",
+           ns_per_op(decimal, [](fixed lhs, fixed rhs) {
+                   bool overflow = false;
+                   return fixed_div(lhs, rhs | 1, &overflow);
+               }),
+           ns_per_op(binary, [](qfixed lhs, qfixed rhs) {
+                   bool overflow = false;
+                   return qfixed_div(lhs, rhs | 1, &overflow);
+               }));
+
+    report("fixed -> qfixed mix",
+           ns_per_op(decimal, [](fixed lhs, fixed rhs) {
+                   return operation_mix(lhs, rhs, fixed_add, fixed_subt,
+                                        fixed_mult, fixed_div, fixed_pow);
+               }),
+           ns_per_op(binary, [](qfixed lhs, qfixed rhs) {
+                   return operation_mix(lhs, rhs, qfixed_add, qfixed_subt,
+                                        qfixed_mult, qfixed_div, qfixed_pow);
+               }));
+
+    char buffer[32];
+    report("fixed -> qfixed repr",
+           ns_per_op(decimal, [&buffer](fixed lhs, fixed) {
+                   return fixed_repr(lhs, buffer, sizeof(buffer))[0];
+               }),
+           ns_per_op(binary, [&buffer](qfixed lhs, qfixed) {
+                   return qfixed_repr(lhs, buffer, sizeof(buffer))[0];
+               }));
+}
+
+TEST_CASE("batch arithmetic benchmark", "[.][benchmark]")
+{
+    /* Enough elements not to fit in the cache, a few of them overflow. */
+    const std::vector<fixed> lhs = sample_operands(4000000, 10);
+    std::vector<fixed> rhs = sample_operands(4000001, 14);
+    rhs.erase(rhs.begin());
+
+    report_batch("fixed_add_n", fixed_add, fixed_add_n, lhs, rhs);
+    report_batch("fixed_mult_n", fixed_mult, fixed_mult_n, lhs, rhs);
+    report_batch("fixed_div_n", fixed_div, fixed_div_n, lhs, rhs);
+}
+
+TEST_CASE("bulk text conversion benchmark", "[.][benchmark]")
+{
+    const std::vector<fixed> numbers = sample_operands(1000000, 4);
+    const size_t n = numbers.size();
+    std::vector<char> text(n * FIXED_REPR_SIZE + 1);
+    char* text_end = text.data();
+
+    report("fixed_to_str_n",
+           ns_per_element(n, [&]() {
+                   char* out = text.data();
+                   for (fixed number : numbers) {
+                       out += fixed_to_str(number, out, FIXED_REPR_SIZE);
+                       *out++ = '\n';
+                   }
+                   *out = '\0';
+                   text_end = out;
+               }),
+           ns_per_element(n, [&]() {
+                   fixed_to_str_n(numbers.data(), n, text.data(), text.size(), &text_end);
+               }));
+
+    std::vector<fixed> parsed(n);
+    std::vector<uint32_t> overflow(FIXED_MASK_WORDS(n));
+
+    report("strn_to_fixed_n",
+           ns_per_element(n, [&]() {
+                   const char* str = text.data();
+                   for (size_t i = 0; i < n; ++i) {
+                       bool number_overflow = false;
+                       char* end;
+                       parsed[i] = strn_to_fixed(str, text_end - str, &end, &number_overflow);
+                       str = (const char*)std::memchr(end, '\n', text_end - end) + 1;
+                   }
+                   sink = parsed[n / 2];
+               }),
+           ns_per_element(n, [&]() {
+                   sink = strn_to_fixed_n(text.data(), text_end - text.data(),
+                                          parsed.data(), n, overflow.data());
+               }));
+
+    CHECK(parsed == numbers);
+}
+
+
+#if ENABLE_ELEMENTARY_FUNCTIONS
+TEST_CASE("elementary functions benchmark", "[.][benchmark]")
+{
+    /* Arguments within +-20 for the functions defined everywhere and
+     * the positive ones for the square root and the logarithm. */
+    const std::vector<fixed> operands = sample_operands(100000, 20);
+    std::vector<fixed> positive(operands.size());
+    for (size_t i = 0; i < operands.size(); ++i) {
+        positive[i] = std::abs(operands[i]) + 1;
+    }
+
+    report("libm -> fixed_sqrt",
+           ns_per_op(positive, [](fixed lhs, fixed) {
+                   return std::lround(std::sqrt((double)lhs / FIXED_SCALE) * FIXED_SCALE);
+               }),
+           ns_per_op(positive, [](fixed lhs, fixed) {
+                   bool overflow = false;
+                   return fixed_sqrt(lhs, &overflow);
+               }));
+
+    report("libm -> fixed_exp",
+           ns_per_op(operands, [](fixed lhs, fixed) {
+                   return std::lround(std::exp((double)lhs / FIXED_SCALE) * FIXED_SCALE);
+               }),
+           ns_per_op(operands, [](fixed lhs, fixed) {
+                   bool overflow = false;
+                   return fixed_exp(lhs, &overflow);
+               }));
+
+    report("libm -> fixed_ln",
+           ns_per_op(positive, [](fixed lhs, fixed) {
+                   return std::lround(std::log((double)lhs / FIXED_SCALE) * FIXED_SCALE);
+               }),
+           ns_per_op(positive, [](fixed lhs, fixed) {
+                   bool overflow = false;
+                   return fixed_ln(lhs, &overflow);
+               }));
+
+    report("libm -> fixed_sin",
+           ns_per_op(operands, [](fixed lhs, fixed) {
+                   return std::lround(std::sin((double)lhs / FIXED_SCALE) * FIXED_SCALE);
+               }),
+           ns_per_op(operands, [](fixed lhs, fixed) {
+                   return fixed_sin(lhs);
+               }));
+
+    report("libm -> fixed_cos",
+           ns_per_op(operands, [](fixed lhs, fixed) {
+                   return std::lround(std::cos((double)lhs / FIXED_SCALE) * FIXED_SCALE);
+               }),
+           ns_per_op(operands, [](fixed lhs, fixed) {
+                   return fixed_cos(lhs);
+               }));
+
+    report("libm -> fixed_atan",
+           ns_per_op(operands, [](fixed lhs, fixed) {
+                   return std::lround(std::atan((double)lhs / FIXED_SCALE) * FIXED_SCALE);
+               }),
+           ns_per_op(operands, [](fixed lhs, fixed) {
+                   return fixed_atan(lhs);
+               }));
+}
+#endif
+
+TEST_CASE("cursor motion benchmark", "[.][benchmark]")
+{
+    /* Accelerometer readings within +-4000 mG. */
+    const std::vector<fixed> operands = sample_operands(100000, 19);
+
+    report("float -> cursor_axis_move",
+           ns_per_op(operands, [](fixed lhs, fixed rhs) {
+                   return reference_move_axis(72, lhs, rhs % 8, 144);
+               }),
+           ns_per_op(operands, [](fixed lhs, fixed rhs) {
+                   CursorAxis axis;
+                   cursor_axis_set(&axis, 72);
+                   cursor_axis_move(&axis, CURSOR_TILT(lhs), CURSOR_GAIN(144),
+                                    (rhs % 8) * CURSOR_PIXEL, 144);
+                   return cursor_axis_pixel(&axis);
+               }));
+}
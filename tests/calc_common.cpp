@@ -0,0 +1 @@
+../src/calc_common.c
\ No newline at end of file
@@ -0,0 +1,264 @@
+// File: calc_type_tests.cpp
+//
+// The same test suite run against every CALC_TYPE backend. The
+// values are given as text so they don't depend on the scale.
+
+#include <cstring>
+#include <string>
+
+#include "catch.hpp"
+
+#include "../src/fixed.h"
+#include "../src/fixed64.h"
+#include "../src/qfixed.h"
+
+namespace {
+
+struct FixedBackend
+{
+    typedef fixed type;
+    static const int fractional_digits = FIXED_FRACTIONAL_DIGITS;
+
+    static type max() { return FIXED_MAX; }
+    static type add(type lhs, type rhs, bool* overflow) { return fixed_add(lhs, rhs, overflow); }
+    static type subt(type lhs, type rhs, bool* overflow) { return fixed_subt(lhs, rhs, overflow); }
+    static type mult(type lhs, type rhs, bool* overflow) { return fixed_mult(lhs, rhs, overflow); }
+    static type div(type lhs, type rhs, bool* overflow) { return fixed_div(lhs, rhs, overflow); }
+    static type pow(type base, int exponent, bool* overflow) { return fixed_pow(base, exponent, overflow); }
+    static type parse(const char* str, bool* overflow) { return str_to_fixed(str, overflow); }
+    static size_t to_str(type n, char* buffer, size_t size) { return fixed_to_str(n, buffer, size); }
+    static type append_digit(type n, int digit, int fractional_digits, bool* overflow)
+    {
+        return fixed_append_digit(n, digit, fractional_digits, overflow);
+    }
+    static type remove_digit(type n, int digit, int fractional_digits)
+    {
+        return fixed_remove_digit(n, digit, fractional_digits);
+    }
+    static int to_int(type n) { return fixed_to_int(n); }
+};
+
+struct Fixed64Backend
+{
+    typedef fixed64 type;
+    static const int fractional_digits = FIXED64_FRACTIONAL_DIGITS;
+
+    static type max() { return FIXED64_MAX; }
+    static type add(type lhs, type rhs, bool* overflow) { return fixed64_add(lhs, rhs, overflow); }
+    static type subt(type lhs, type rhs, bool* overflow) { return fixed64_subt(lhs, rhs, overflow); }
+    static type mult(type lhs, type rhs, bool* overflow) { return fixed64_mult(lhs, rhs, overflow); }
+    static type div(type lhs, type rhs, bool* overflow) { return fixed64_div(lhs, rhs, overflow); }
+    static type pow(type base, int exponent, bool* overflow) { return fixed64_pow(base, exponent, overflow); }
+    static type parse(const char* str, bool* overflow) { return str_to_fixed64(str, overflow); }
+    static size_t to_str(type n, char* buffer, size_t size) { return fixed64_to_str(n, buffer, size); }
+    static type append_digit(type n, int digit, int fractional_digits, bool* overflow)
+    {
+        return fixed64_append_digit(n, digit, fractional_digits, overflow);
+    }
+    static type remove_digit(type n, int digit, int fractional_digits)
+    {
+        return fixed64_remove_digit(n, digit, fractional_digits);
+    }
+    static int to_int(type n) { return fixed64_to_int(n); }
+};
+
+struct QfixedBackend
+{
+    typedef qfixed type;
+    static const int fractional_digits = QFIXED_FRACTIONAL_DIGITS;
+
+    static type max() { return QFIXED_MAX; }
+    static type add(type lhs, type rhs, bool* overflow) { return qfixed_add(lhs, rhs, overflow); }
+    static type subt(type lhs, type rhs, bool* overflow) { return qfixed_subt(lhs, rhs, overflow); }
+    static type mult(type lhs, type rhs, bool* overflow) { return qfixed_mult(lhs, rhs, overflow); }
+    static type div(type lhs, type rhs, bool* overflow) { return qfixed_div(lhs, rhs, overflow); }
+    static type pow(type base, int exponent, bool* overflow) { return qfixed_pow(base, exponent, overflow); }
+    static type parse(const char* str, bool* overflow) { return str_to_qfixed(str, overflow); }
+    static size_t to_str(type n, char* buffer, size_t size) { return qfixed_to_str(n, buffer, size); }
+    static type append_digit(type n, int digit, int fractional_digits, bool* overflow)
+    {
+        return qfixed_append_digit(n, digit, fractional_digits, overflow);
+    }
+    static type remove_digit(type n, int digit, int fractional_digits)
+    {
+        return qfixed_remove_digit(n, digit, fractional_digits);
+    }
+    static int to_int(type n) { return qfixed_to_int(n); }
+};
+
+/** Check whether a number is in the range of the backend. */
+template <typename Backend>
+bool in_range(const char* str)
+{
+    bool overflow = false;
+    Backend::parse(str, &overflow);
+    return !overflow;
+}
+
+/** Check whether a number has no more decimal places than the
+ *  backend keeps. */
+template <typename Backend>
+bool exact(const char* str)
+{
+    const char* point = std::strchr(str, '.');
+    return point == NULL || (int)std::strlen(point + 1) <= Backend::fractional_digits;
+}
+
+/** Parse a number expected to be in range. */
+template <typename Backend>
+typename Backend::type num(const char* str)
+{
+    bool overflow = false;
+    typename Backend::type n = Backend::parse(str, &overflow);
+    REQUIRE(overflow == false);
+    return n;
+}
+
+/** Represent a number as text. */
+template <typename Backend>
+std::string str(typename Backend::type n)
+{
+    char buffer[32];
+    size_t length = Backend::to_str(n, buffer, sizeof(buffer));
+    return std::string(buffer, length);
+}
+
+template <typename Backend>
+void test_arithmetic()
+{
+    bool overflow = false;
+
+    CHECK(str<Backend>(Backend::add(num<Backend>("1.5"), num<Backend>("2.7"), &overflow)) == "4.2");
+    CHECK(str<Backend>(Backend::subt(num<Backend>("1.5"), num<Backend>("2.7"), &overflow)) == "-1.2");
+    CHECK(str<Backend>(Backend::mult(num<Backend>("1.5"), num<Backend>("-3"), &overflow)) == "-4.5");
+    if (exact<Backend>("0.25")) {
+        CHECK(str<Backend>(Backend::add(num<Backend>("1.25"), num<Backend>("2.5"), &overflow)) == "3.75");
+        CHECK(str<Backend>(Backend::subt(num<Backend>("1.25"), num<Backend>("2.5"), &overflow)) == "-1.25");
+        CHECK(str<Backend>(Backend::mult(num<Backend>("1.5"), num<Backend>("-2.5"), &overflow)) == "-3.75");
+        CHECK(str<Backend>(Backend::div(num<Backend>("1"), num<Backend>("-4"), &overflow)) == "-0.25");
+    }
+    if (in_range<Backend>("998001")) {
+        CHECK(str<Backend>(Backend::mult(num<Backend>("-999"), num<Backend>("-999"), &overflow)) == "998001");
+    }
+    CHECK(str<Backend>(Backend::div(num<Backend>("7.5"), num<Backend>("2.5"), &overflow)) == "3");
+    CHECK(str<Backend>(Backend::pow(num<Backend>("2"), 10, &overflow)) == "1024");
+    CHECK(str<Backend>(Backend::pow(num<Backend>("0.5"), -2, &overflow)) == "4");
+    CHECK(str<Backend>(Backend::pow(num<Backend>("0.5"), -10, &overflow)) == "1024");
+    CHECK(str<Backend>(Backend::pow(num<Backend>("-0.5"), -3, &overflow)) == "-8");
+    if (in_range<Backend>("1048576")) {
+        CHECK(str<Backend>(Backend::pow(num<Backend>("0.5"), -20, &overflow)) == "1048576");
+    }
+    /* Only where the tenths are exact, 0.1 is a little more than that in binary. */
+    if (Backend::mult(num<Backend>("0.1"), num<Backend>("10"), &overflow) == num<Backend>("1")) {
+        CHECK(str<Backend>(Backend::pow(num<Backend>("0.1"), -3, &overflow)) == "1000");
+        CHECK(str<Backend>(Backend::pow(num<Backend>("0.2"), -4, &overflow)) == "625");
+    }
+    CHECK(str<Backend>(Backend::pow(num<Backend>("-1"), 1000001, &overflow)) == "-1");
+    CHECK(str<Backend>(Backend::pow(num<Backend>("2"), -1000000, &overflow)) == "0");
+    CHECK(Backend::to_int(num<Backend>("-12.99")) == -12);
+    REQUIRE(overflow == false);
+}
+
+template <typename Backend>
+void test_overflow()
+{
+    bool overflow = false;
+
+    Backend::add(Backend::max(), num<Backend>("1"), &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    Backend::mult(Backend::max(), num<Backend>("1.5"), &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    Backend::div(Backend::max(), num<Backend>("0.5"), &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    Backend::div(num<Backend>("1"), num<Backend>("0"), &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    Backend::pow(num<Backend>("2"), 1000000, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    /* One integral digit more than the maximum has. */
+    std::string too_long = str<Backend>(Backend::max());
+    too_long.insert(0, "1");
+    Backend::parse(too_long.c_str(), &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+}
+
+template <typename Backend>
+void test_text()
+{
+    const char* numbers[] = {"0", "12.34", "-12.34", "0.1", "-0.01", "1000", "-7.5"};
+    for (const char* n : numbers) {
+        if (exact<Backend>(n)) {
+            CHECK(str<Backend>(num<Backend>(n)) == n);
+        }
+    }
+
+    CHECK(str<Backend>(Backend::max()) == str<Backend>(num<Backend>(str<Backend>(Backend::max()).c_str())));
+    CHECK(str<Backend>(-Backend::max()) == "-" + str<Backend>(Backend::max()));
+    CHECK(str<Backend>(num<Backend>("3.1000")) == "3.1");
+}
+
+template <typename Backend>
+void test_digits()
+{
+    bool overflow = false;
+    typename Backend::type n = 0;
+
+    /* Type "42.05" digit by digit... */
+    n = Backend::append_digit(n, 4, -1, &overflow);
+    n = Backend::append_digit(n, 2, -1, &overflow);
+    n = Backend::append_digit(n, 0, 0, &overflow);
+    n = Backend::append_digit(n, 5, 1, &overflow);
+    REQUIRE(overflow == false);
+    CHECK(n == num<Backend>("42.05"));
+
+    /* ...and delete it back. */
+    n = Backend::remove_digit(n, 5, 1);
+    CHECK(n == num<Backend>("42"));
+    n = Backend::remove_digit(n, 0, 0);
+    n = Backend::remove_digit(n, 2, -1);
+    CHECK(n == num<Backend>("4"));
+
+    /* The digits beyond the precision are ignored. */
+    CHECK(Backend::append_digit(n, 9, Backend::fractional_digits, &overflow) == n);
+    REQUIRE(overflow == false);
+
+    Backend::append_digit(Backend::max(), 0, -1, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+}
+
+template <typename Backend>
+void test_backend()
+{
+    SECTION("arithmetic") { test_arithmetic<Backend>(); }
+    SECTION("overflow") { test_overflow<Backend>(); }
+    SECTION("text") { test_text<Backend>(); }
+    SECTION("digits") { test_digits<Backend>(); }
+}
+
+} // namespace
+
+TEST_CASE("fixed backend", "[calc-type]")
+{
+    test_backend<FixedBackend>();
+}
+
+TEST_CASE("fixed64 backend", "[calc-type]")
+{
+    test_backend<Fixed64Backend>();
+}
+
+TEST_CASE("qfixed backend", "[calc-type]")
+{
+    test_backend<QfixedBackend>();
+}
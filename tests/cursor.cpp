@@ -0,0 +1 @@
+../src/cursor.c
\ No newline at end of file
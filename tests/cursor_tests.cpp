@@ -0,0 +1,261 @@
+// File: cursor_tests.cpp
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "catch.hpp"
+
+#include "../src/cursor.h"
+
+namespace {
+
+const int screen_w = 144;
+const int keypad_height = 124;
+
+} // namespace
+
+TEST_CASE("cursor tilt velocity", "[cursor]")
+{
+    /* Rounded to the nearest sub-pixel, off by at most the gain
+     * rounding error of below 2^-18 sub-pixel per mG. */
+    const int sizes[] = {1, screen_w, keypad_height, 152, CURSOR_ACCEL_MAX};
+    for (int size : sizes) {
+        int mismatches = 0;
+        for (int tilt = -2 * CURSOR_ACCEL_MAX; tilt <= 2 * CURSOR_ACCEL_MAX; ++tilt) {
+            const double exact = (double)tilt * size * CURSOR_PIXEL / CURSOR_ACCEL_MAX;
+            const int32_t velocity = cursor_tilt_velocity(CURSOR_TILT(tilt), CURSOR_GAIN(size));
+            const double error = 0.5 + std::abs(tilt) / (double)(1 << 18);
+            mismatches += velocity < exact - error || velocity > exact + error;
+        }
+        INFO("size: " << size);
+        CHECK(mismatches == 0);
+        CHECK(cursor_tilt_velocity(CURSOR_TILT(CURSOR_ACCEL_MAX), CURSOR_GAIN(size)) == size * CURSOR_PIXEL);
+        CHECK(cursor_tilt_velocity(CURSOR_TILT(-CURSOR_ACCEL_MAX), CURSOR_GAIN(size)) == -size * CURSOR_PIXEL);
+    }
+}
+
+TEST_CASE("slow tilts accumulate", "[cursor]")
+{
+    CursorAxis axis;
+    cursor_axis_set(&axis, 72);
+
+    /* 20 mG is 0.72 px per sample, which used to be truncated to 0. */
+    for (int i = 0; i < 10; ++i) {
+        cursor_axis_move(&axis, CURSOR_TILT(20), CURSOR_GAIN(screen_w), 0, screen_w);
+    }
+    CHECK(cursor_axis_pixel(&axis) == 72 + 7);
+    CHECK(axis.velocity == cursor_tilt_velocity(CURSOR_TILT(20), CURSOR_GAIN(screen_w)));
+
+    for (int i = 0; i < 10; ++i) {
+        cursor_axis_move(&axis, CURSOR_TILT(-20), CURSOR_GAIN(screen_w), 0, screen_w);
+    }
+    CHECK(cursor_axis_pixel(&axis) == 72);
+}
+
+TEST_CASE("cursor stays on the screen", "[cursor]")
+{
+    CursorAxis axis;
+    cursor_axis_set(&axis, 0);
+    cursor_axis_move(&axis, CURSOR_TILT(-CURSOR_ACCEL_MAX), CURSOR_GAIN(screen_w), -CURSOR_PIXEL, screen_w);
+    CHECK(axis.position == 0);
+
+    cursor_axis_set(&axis, keypad_height);
+    cursor_axis_move(&axis, CURSOR_TILT(CURSOR_ACCEL_MAX), CURSOR_GAIN(152), CURSOR_PIXEL, keypad_height);
+    CHECK(cursor_axis_pixel(&axis) == keypad_height);
+    CHECK(axis.position == keypad_height * CURSOR_PIXEL);
+}
+
+TEST_CASE("cursor is pulled to the button center", "[cursor]")
+{
+    CursorAxis axis;
+    cursor_axis_set(&axis, 60);
+    CHECK(cursor_axis_pull(&axis, 70, 10) == CURSOR_PIXEL);
+    CHECK(cursor_axis_pull(&axis, 50, 10) == -CURSOR_PIXEL);
+
+    /* Without any tilt it settles at the center instead of stopping
+     * within STEEPNESS_FACTOR pixels from it. */
+    for (int i = 0; i < 100; ++i) {
+        cursor_axis_move(&axis, 0, CURSOR_GAIN(screen_w),
+                         cursor_axis_pull(&axis, 70, 10), screen_w);
+    }
+    CHECK(cursor_axis_pixel(&axis) == 69);
+    CHECK(cursor_axis_pull(&axis, 70, 10) == 0);
+}
+
+TEST_CASE("cursor filter without smoothing", "[cursor]")
+{
+    CursorFilter filter = {0, 0};
+    cursor_filter_add(&filter, CURSOR_TILT(123), 0);
+    CHECK(cursor_filter_take(&filter, CURSOR_REFERENCE_RATE) == CURSOR_TILT(123));
+    cursor_filter_add(&filter, CURSOR_TILT(-45), 0);
+    CHECK(cursor_filter_take(&filter, CURSOR_REFERENCE_RATE) == CURSOR_TILT(-45));
+    CHECK(cursor_filter_take(&filter, CURSOR_REFERENCE_RATE) == 0);
+}
+
+TEST_CASE("cursor filter smooths the samples", "[cursor]")
+{
+    CursorFilter filter = {0, 0};
+
+    /* A step halves its distance with every sample. */
+    cursor_filter_add(&filter, CURSOR_TILT(100), 1);
+    CHECK(filter.tilt == CURSOR_TILT(50));
+    cursor_filter_add(&filter, CURSOR_TILT(100), 1);
+    CHECK(filter.tilt == CURSOR_TILT(75));
+    CHECK(cursor_filter_take(&filter, CURSOR_REFERENCE_RATE) == CURSOR_TILT(125));
+
+    /* A lone spike is damped. */
+    filter = CursorFilter{0, 0};
+    cursor_filter_add(&filter, CURSOR_TILT(1000), 2);
+    cursor_filter_add(&filter, CURSOR_TILT(0), 2);
+    cursor_filter_add(&filter, CURSOR_TILT(0), 2);
+    CHECK(filter.tilt < CURSOR_TILT(250));
+    CHECK(cursor_filter_take(&filter, CURSOR_REFERENCE_RATE)
+          == CURSOR_TILT(250) + CURSOR_TILT(250) * 3 / 4 + CURSOR_TILT(250) * 9 / 16);
+}
+
+TEST_CASE("cursor speed does not depend on the sampling rate", "[cursor]")
+{
+    const int rates[] = {10, 25, 50, 100};
+    const int batch_sizes[] = {1, 2, 5, 10};
+    for (int rate : rates) {
+        for (int batch_size : batch_sizes) {
+            if (rate % batch_size != 0) {
+                continue;
+            }
+
+            /* One second of a steady tilt moving 0.36 px per sample at
+             * the reference rate. */
+            CursorFilter filter = {CURSOR_TILT(10), 0};
+            CursorAxis axis;
+            cursor_axis_set(&axis, 60);
+            for (int batch = 0; batch < rate / batch_size; ++batch) {
+                for (int i = 0; i < batch_size; ++i) {
+                    cursor_filter_add(&filter, CURSOR_TILT(10), 1);
+                }
+                cursor_axis_move(&axis, cursor_filter_take(&filter, rate),
+                                 CURSOR_GAIN(screen_w), 0, screen_w);
+            }
+            INFO("rate: " << rate << ", batch size: " << batch_size);
+            CHECK(std::abs(axis.position - 69 * CURSOR_PIXEL) <= rate / batch_size);
+        }
+    }
+}
+
+TEST_CASE("cursor steepness rescaled to batches", "[cursor]")
+{
+    CHECK(cursor_batch_steepness(10, 1, 25) == 10);
+    CHECK(cursor_batch_steepness(10, 5, 50) == 4);
+    CHECK(cursor_batch_steepness(10, 10, 25) == 1);
+    CHECK(cursor_batch_steepness(10, 1, 100) == 40);
+}
+
+namespace {
+
+/** Feed a batch of samples changing by @p amplitude each, the batch
+ *  size is even so the next batch continues the alternation. */
+bool activity_batch(CursorActivity* activity, int samples, int amplitude, bool on_button)
+{
+    for (int i = 0; i < samples; ++i) {
+        cursor_activity_add(activity, i % 2 ? 0 : amplitude, 0);
+    }
+    return cursor_activity_update(activity, on_button);
+}
+
+} // namespace
+
+TEST_CASE("sampling rate lowered only after the watch is still for long", "[cursor]")
+{
+    CursorActivity activity = CursorActivity();
+
+    /* Still, but not resting on a button. */
+    for (int i = 0; i < 2 * MOTION_REST_BATCHES; ++i) {
+        CHECK_FALSE(activity_batch(&activity, 4, 0, false));
+    }
+
+    /* A motion resets the count. */
+    for (int i = 0; i < MOTION_REST_BATCHES - 1; ++i) {
+        CHECK_FALSE(activity_batch(&activity, 4, 0, true));
+    }
+    CHECK_FALSE(activity_batch(&activity, 4, MOTION_REST_THRESHOLD, true));
+    for (int i = 0; i < MOTION_REST_BATCHES - 1; ++i) {
+        CHECK_FALSE(activity_batch(&activity, 4, 0, true));
+    }
+    CHECK_FALSE(activity.resting);
+    CHECK(cursor_activity_batch_size(&activity) == ACCEL_BATCH_SIZE);
+
+    CHECK(activity_batch(&activity, 4, 0, true));
+    CHECK(activity.resting);
+    CHECK(activity.switches == 1);
+
+    /* Fewer wakeups: the resting batches are longer. */
+    CHECK(cursor_activity_batch_size(&activity) == ACCEL_REST_BATCH_SIZE);
+    CHECK(ACCEL_REST_BATCH_SIZE > ACCEL_BATCH_SIZE);
+}
+
+TEST_CASE("sampling rate restored on the first motion", "[cursor]")
+{
+    CursorActivity activity = CursorActivity();
+    for (int i = 0; i < MOTION_REST_BATCHES; ++i) {
+        activity_batch(&activity, 4, 0, true);
+    }
+    REQUIRE(activity.resting);
+
+    /* Between the thresholds nothing changes. */
+    CHECK_FALSE(activity_batch(&activity, 4, (MOTION_REST_THRESHOLD + MOTION_WAKE_THRESHOLD) / 2, true));
+    CHECK(activity.resting);
+
+    CHECK(activity_batch(&activity, 4, MOTION_WAKE_THRESHOLD + 1, true));
+    CHECK_FALSE(activity.resting);
+
+    /* Leaving the button also counts as a motion. */
+    for (int i = 0; i < MOTION_REST_BATCHES; ++i) {
+        activity_batch(&activity, 4, 0, true);
+    }
+    REQUIRE(activity.resting);
+    CHECK(activity_batch(&activity, 4, 0, false));
+    CHECK_FALSE(activity.resting);
+    CHECK(activity.switches == 4);
+}
+
+TEST_CASE("sampling counters", "[cursor]")
+{
+    CursorActivity activity = CursorActivity();
+    for (int i = 0; i < MOTION_REST_BATCHES; ++i) {
+        activity_batch(&activity, 4, 0, true);
+    }
+    activity_batch(&activity, 4, 0, true);
+    activity_batch(&activity, 4, 0, true);
+
+    CHECK(activity.active_batches == MOTION_REST_BATCHES);
+    CHECK(activity.resting_batches == 2);
+    /* The very first sample has no predecessor. */
+    CHECK(activity.active_samples == 4 * MOTION_REST_BATCHES - 1);
+    CHECK(activity.resting_samples == 8);
+}
+
+TEST_CASE("calibration starts with the first batch", "[cursor]")
+{
+    CursorCalibration calibration = CursorCalibration();
+    cursor_calibration_update(&calibration, 5 * 40, 5 * -980, 5, 4);
+    CHECK(calibration.calibrated);
+    CHECK(calibration.zero_x == CURSOR_TILT(40));
+    CHECK(calibration.zero_y == CURSOR_TILT(-980));
+}
+
+TEST_CASE("calibration follows the drift", "[cursor]")
+{
+    CursorCalibration calibration = CursorCalibration();
+    cursor_calibration_update(&calibration, 0, 0, 5, 4);
+
+    /* Half of the distance for every batch with the shift of 1. */
+    cursor_calibration_update(&calibration, 5 * 100, 5 * -100, 5, 1);
+    CHECK(calibration.zero_x == CURSOR_TILT(50));
+    CHECK(calibration.zero_y == CURSOR_TILT(-50));
+
+    /* Converges to the new balance point, keeping the fraction. */
+    for (int i = 0; i < 200; ++i) {
+        cursor_calibration_update(&calibration, 3 * 7, 3 * 7 + 1, 3, 4);
+    }
+    CHECK(std::abs(calibration.zero_x - CURSOR_TILT(7)) < 16);
+    CHECK(std::abs(calibration.zero_y - CURSOR_TILT(7) - CURSOR_TILT(1) / 3) < 16);
+}
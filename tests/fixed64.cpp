@@ -0,0 +1 @@
+../src/fixed64.c
\ No newline at end of file
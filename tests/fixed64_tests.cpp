@@ -0,0 +1,121 @@
+// File: fixed64_tests.cpp
+
+#include <string>
+
+#include "catch.hpp"
+
+#include "../src/fixed64.h"
+
+/* Test the portable 128-bit helpers used on ARM against the native
+ * type of the host compiler. */
+#define WIDE_INT_PORTABLE
+#include "../src/wide_int.h"
+
+TEST_CASE("64-bit multiplication", "[fixed64]")
+{
+    bool overflow = false;
+
+    CHECK(fixed64_mult(1234567, 5739000, &overflow) == 7085180LL);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed64_mult(-1234567, 5739000, &overflow) == -7085180LL);
+    REQUIRE(overflow == false);
+
+    /* 3037000.499 squared is just below the maximum. */
+    CHECK(fixed64_mult(3037000499000LL, 3037000499000LL, &overflow) == 9223372030926249001LL);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed64_mult(FIXED64_MAX, 1000000, &overflow) == FIXED64_MAX);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed64_mult(FIXED64_MAX, 1, &overflow) == 9223372036854LL);
+    REQUIRE(overflow == false);
+
+    fixed64_mult(3037000500000LL, 3037000500000LL, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+}
+
+TEST_CASE("64-bit division", "[fixed64]")
+{
+    bool overflow = false;
+
+    CHECK(fixed64_div(1234000, 5739000, &overflow) == 215020);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed64_div(-1234000, 5739000, &overflow) == -215020);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed64_div(FIXED64_MAX, 3000000, &overflow) == 3074457345618258602LL);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed64_div(1, FIXED64_MAX, &overflow) == 0);
+    REQUIRE(overflow == false);
+
+    fixed64_div(FIXED64_MAX, 999999, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+}
+
+TEST_CASE("64-bit text representation", "[fixed64]")
+{
+    char buffer[FIXED64_REPR_SIZE];
+
+    CHECK(fixed64_to_str(FIXED64_MAX, buffer, sizeof(buffer)) == 20);
+    CHECK(std::string(buffer) == "9223372036854.775807");
+
+    CHECK(fixed64_to_str(-FIXED64_MAX, buffer, sizeof(buffer)) == 21);
+    CHECK(std::string(buffer) == "-9223372036854.775807");
+
+    CHECK(fixed64_to_str(1, buffer, sizeof(buffer)) == 8);
+    CHECK(std::string(buffer) == "0.000001");
+
+    CHECK(fixed64_to_str(4200000000LL, buffer, sizeof(buffer)) == 4);
+    CHECK(std::string(buffer) == "4200");
+
+    CHECK(fixed64_to_str(-1234500, buffer, 4) == 3);
+    CHECK(std::string(buffer) == "-1.");
+
+    bool overflow = false;
+    CHECK(str_to_fixed64("9223372036854.775807", &overflow) == FIXED64_MAX);
+    REQUIRE(overflow == false);
+
+    CHECK(str_to_fixed64("-0.0000019", &overflow) == -1);
+    REQUIRE(overflow == false);
+
+    str_to_fixed64("9223372036854.775808", &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+}
+
+TEST_CASE("portable 128-bit arithmetic", "[fixed64]")
+{
+    REQUIRE(WIDE_INT_NATIVE == 0);
+
+    unsigned long long seed = 88172645463325252ULL;
+    for (int i = 0; i < 10000; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        uint64_t a = seed;
+        uint64_t b = seed * 0x9E3779B97F4A7C15ULL >> (i % 64);
+        uint64_t d = (b >> (i % 40)) | 1;
+        unsigned __int128 product = (unsigned __int128)a * b;
+
+        uint64_t hi;
+        uint64_t lo = wide_mul_u64(a, b, &hi);
+        CHECK(lo == (uint64_t)product);
+        CHECK(hi == (uint64_t)(product >> 64));
+        CHECK(wide_umulh64(a, b) == (uint64_t)(product >> 64));
+
+        /* Keep the quotient in 64 bits. */
+        unsigned __int128 dividend = product % ((unsigned __int128)d << 64);
+        CHECK(wide_div_u64((uint64_t)(dividend >> 64), (uint64_t)dividend, d)
+              == (uint64_t)(dividend / d));
+
+        uint32_t small = (uint32_t)(d % 0xFFFFFF) + 1;
+        dividend = product % ((unsigned __int128)small << 64);
+        CHECK(wide_div_small((uint64_t)(dividend >> 64), (uint64_t)dividend, small)
+              == (uint64_t)(dividend / small));
+    }
+}
@@ -0,0 +1 @@
+../src/fixed_batch.c
\ No newline at end of file
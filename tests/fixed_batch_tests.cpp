@@ -0,0 +1,201 @@
+// File: fixed_batch_tests.cpp
+
+#include <climits>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "../src/fixed_batch.h"
+
+namespace {
+
+typedef size_t (*batch_fn)(const fixed*, const fixed*, fixed*, size_t, uint32_t*);
+typedef fixed (*scalar_fn)(fixed, fixed, bool*);
+
+/** Operands of all magnitudes mixed with the edge cases. */
+std::vector<fixed> sample_operands(size_t count, unsigned int seed)
+{
+    const fixed edges[] = {
+        0, 1, -1, FIXED_SCALE, -FIXED_SCALE, FIXED_MAX, -FIXED_MAX,
+        FIXED_MAX - 1, FIXED_MAX / 2, FIXED_MAX / 2 + 1, -FIXED_MAX / 2 - 1,
+        FIXED_SCALE * FIXED_SCALE, 46341, -46341,
+    };
+    std::vector<fixed> operands(count);
+    for (size_t i = 0; i < count; ++i) {
+        seed = seed * 1103515245 + 12345;
+        if (seed % 8 == 0) {
+            operands[i] = edges[(seed >> 8) % (sizeof(edges) / sizeof(*edges))];
+        } else {
+            operands[i] = (fixed)(seed ^ (seed << 7)) >> (seed >> 27);
+        }
+    }
+    return operands;
+}
+
+/** Check every lane against the scalar function. */
+void check_against_scalar(batch_fn batch, scalar_fn scalar, size_t n)
+{
+    const std::vector<fixed> lhs = sample_operands(n, 1 + n);
+    const std::vector<fixed> rhs = sample_operands(n, 1000 + n);
+    std::vector<fixed> result(n);
+    std::vector<uint32_t> overflow(FIXED_MASK_WORDS(n) + 1, 0xDEADBEEF);
+
+    size_t overflows = batch(lhs.data(), rhs.data(), result.data(), n, overflow.data());
+
+    size_t expected_overflows = 0;
+    for (size_t i = 0; i < n; ++i) {
+        bool expected_overflow = false;
+        fixed expected = scalar(lhs[i], rhs[i], &expected_overflow);
+        bool lane_overflow = (overflow[i / 32] >> (i % 32)) & 1;
+
+        INFO(lhs[i] << ", " << rhs[i]);
+        REQUIRE(lane_overflow == expected_overflow);
+        if (!expected_overflow) {
+            REQUIRE(result[i] == expected);
+        }
+        expected_overflows += expected_overflow;
+    }
+    CHECK(overflows == expected_overflows);
+
+    /* The unused bits are cleared and nothing is written past the mask. */
+    if (n % 32 != 0) {
+        CHECK((overflow[n / 32] >> (n % 32)) == 0);
+    }
+    CHECK(overflow[FIXED_MASK_WORDS(n)] == 0xDEADBEEF);
+}
+
+} // namespace
+
+TEST_CASE("batch arithmetic", "[fixed-batch]")
+{
+    const size_t sizes[] = {0, 1, 3, 4, 5, 31, 32, 33, 100, 10007};
+    for (size_t n : sizes) {
+        check_against_scalar(fixed_add_n, fixed_add, n);
+        check_against_scalar(fixed_mult_n, fixed_mult, n);
+        check_against_scalar(fixed_div_n, fixed_div, n);
+    }
+}
+
+TEST_CASE("batch arithmetic in place", "[fixed-batch]")
+{
+    const fixed one = FIXED_SCALE;
+    std::vector<fixed> numbers = {one, 5 * one / 2, -one / 2, FIXED_MAX, 7, 0, -1, 3 * one, 12345};
+    const std::vector<fixed> divisors = {3 * one, one / 2, one / 2, one / 2, 0, 1, 3, -3 * one, one};
+    std::vector<uint32_t> overflow(FIXED_MASK_WORDS(numbers.size()));
+
+    CHECK(fixed_div_n(numbers.data(), divisors.data(), numbers.data(),
+                      numbers.size(), overflow.data()) == 2);
+    CHECK(overflow[0] == ((1u << 3) | (1u << 4)));
+
+    CHECK(numbers[0] == one / 3);
+    CHECK(numbers[1] == 5 * one);
+    CHECK(numbers[2] == -one);
+    CHECK(numbers[5] == 0);
+    CHECK(numbers[6] == -one / 3);
+    CHECK(numbers[7] == -one);
+    CHECK(numbers[8] == 12345);
+}
+
+TEST_CASE("bulk conversion from text", "[fixed-batch]")
+{
+    std::vector<std::string> lines = {
+        "0", "1", "-1", "12.34", "-12.34", "0.5", "-0.05", ".5", "-.25", "5.",
+        "21474836.47", "-21474836.47", "21474836.48", "21474837", "99999999999999999",
+        "000000000000000012.5", "12345678", "123456789", "1.23456789", "3.14abc",
+        "", "-", ".", "abc", "1.2.3", " 7", "7 ", "1e5", "-0", "0.001", "\r",
+        "12345678.9", "87654321", "00000000", "9999999.99",
+    };
+
+    /* A lot of pseudorandom ones around the limits. */
+    unsigned int seed = 42;
+    char buffer[32];
+    for (int i = 0; i < 2000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        std::snprintf(buffer, sizeof(buffer), "%s%u.%0*u",
+                      seed & 1 ? "-" : "",
+                      (seed >> 1) % (FIXED_INTEGRAL_MAX + 2),
+                      (int)(seed >> 28) % 6,
+                      (seed >> 8) % 100000);
+        lines.push_back(buffer);
+    }
+
+    std::string text;
+    for (const std::string& line : lines) {
+        text += line + "\n";
+    }
+    /* The last line doesn't need a newline. */
+    text.pop_back();
+
+    std::vector<fixed> numbers(lines.size() + 10);
+    std::vector<uint32_t> overflow(FIXED_MASK_WORDS(numbers.size()));
+    REQUIRE(strn_to_fixed_n(text.data(), text.size(), numbers.data(), numbers.size(),
+                            overflow.data()) == lines.size());
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        bool expected_overflow = false;
+        fixed expected = strn_to_fixed(lines[i].data(), lines[i].size(), NULL, &expected_overflow);
+        bool line_overflow = (overflow[i / 32] >> (i % 32)) & 1;
+
+        INFO(lines[i]);
+        REQUIRE(line_overflow == expected_overflow);
+        REQUIRE(numbers[i] == expected);
+    }
+
+    /* Stop when the array is full. */
+    CHECK(strn_to_fixed_n(text.data(), text.size(), numbers.data(), 3, overflow.data()) == 3);
+    CHECK(strn_to_fixed_n("1\n2\n", 4, numbers.data(), numbers.size(), overflow.data()) == 2);
+    CHECK(strn_to_fixed_n("", 0, numbers.data(), numbers.size(), overflow.data()) == 0);
+}
+
+TEST_CASE("bulk conversion to text", "[fixed-batch]")
+{
+    std::vector<fixed> numbers = {
+        0, 1, -1, 10, -10, 1234, -1234, FIXED_MAX, -FIXED_MAX, FIXED_SCALE,
+        FIXED_SCALE * 100000, 99999999, 100000000, 123456789,
+    };
+    unsigned int seed = 7;
+    for (int i = 0; i < 10000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        numbers.push_back((fixed)(seed ^ (seed << 9)) >> (seed >> 27));
+    }
+
+    std::string expected;
+    char line[FIXED_REPR_SIZE];
+    for (fixed n : numbers) {
+        fixed_to_str(n, line, sizeof(line));
+        expected += line;
+        expected += "\n";
+    }
+
+    std::vector<char> text(numbers.size() * FIXED_REPR_SIZE + 1);
+    char* end;
+    REQUIRE(fixed_to_str_n(numbers.data(), numbers.size(), text.data(), text.size(), &end)
+            == numbers.size());
+    CHECK(std::string(text.data(), end) == expected);
+    CHECK(*end == '\0');
+
+    /* The round trip is exact. */
+    std::vector<fixed> parsed(numbers.size());
+    std::vector<uint32_t> overflow(FIXED_MASK_WORDS(numbers.size()));
+    REQUIRE(strn_to_fixed_n(text.data(), end - text.data(), parsed.data(), parsed.size(),
+                            overflow.data()) == numbers.size());
+    CHECK(parsed == numbers);
+    for (uint32_t word : overflow) {
+        CHECK(word == 0);
+    }
+
+    /* Only the whole lines are written to a short buffer. */
+    const fixed few[] = {1234, -5, 100};
+    std::string two_lines;
+    for (int i = 0; i < 2; ++i) {
+        fixed_to_str(few[i], line, sizeof(line));
+        two_lines += line;
+        two_lines += "\n";
+    }
+    /* Room for the terminating null character but not the third line. */
+    std::vector<char> short_buffer(two_lines.size() + 2);
+    CHECK(fixed_to_str_n(few, 3, short_buffer.data(), short_buffer.size(), &end) == 2);
+    CHECK(std::string(short_buffer.data()) == two_lines);
+}
+
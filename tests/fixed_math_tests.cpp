@@ -0,0 +1,159 @@
+// File: fixed_math_tests.cpp
+
+#include <climits>
+#include <cmath>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "../src/fixed.h"
+
+#if ENABLE_ELEMENTARY_FUNCTIONS
+
+namespace {
+
+/** Whether @p result is @p reference rounded to the nearest fixed
+ *  point number. The host reference is computed in long double, so
+ *  the results within its error from a tie may round either way. */
+bool rounds_to(fixed result, long double reference)
+{
+    const long double scaled = reference * FIXED_SCALE;
+    if (result == std::llround(scaled)) {
+        return true;
+    }
+    return std::fabs(scaled - std::floor(scaled) - 0.5L) < 1e-6L
+        && std::fabs(result - scaled) < 1;
+}
+
+/** Every number in [@p first, @p last] followed by a sample of the
+ *  whole range. */
+std::vector<fixed> arguments(fixed first, fixed last)
+{
+    std::vector<fixed> numbers;
+    for (long long n = first; n <= last; ++n) {
+        numbers.push_back((fixed)n);
+    }
+    unsigned int seed = 1;
+    for (int i = 0; i < 100000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        numbers.push_back((fixed)(seed ^ (seed << 7)) >> (seed >> 27));
+    }
+    numbers.push_back(FIXED_MAX);
+    numbers.push_back(-FIXED_MAX);
+    return numbers;
+}
+
+/** Check @p f against the host @p reference on @p numbers, reporting
+ *  only the first mismatch. */
+template <typename F, typename R>
+void check_against_reference(const std::vector<fixed>& numbers, F f, R reference)
+{
+    size_t mismatches = 0;
+    fixed first_mismatch = 0;
+    for (fixed n : numbers) {
+        if (!rounds_to(f(n), reference((long double)n / FIXED_SCALE))) {
+            if (mismatches++ == 0) {
+                first_mismatch = n;
+            }
+        }
+    }
+    INFO("first mismatch: " << first_mismatch << " -> " << f(first_mismatch));
+    CHECK(mismatches == 0);
+}
+
+} // namespace
+
+TEST_CASE("square root", "[fixed][math]")
+{
+    /* The exact check: (2r - 1)^2 <= 4n < (2r + 1)^2, the ties cannot
+     * happen for the integers. */
+    size_t mismatches = 0;
+    for (fixed n : arguments(0, 1000000)) {
+        if (n < 0) {
+            continue;
+        }
+        bool overflow = false;
+        long long root = fixed_sqrt(n, &overflow);
+        unsigned __int128 square = (unsigned __int128)4 * n * FIXED_SCALE;
+        unsigned __int128 below = (unsigned __int128)(2 * root - 1) * (2 * root - 1);
+        unsigned __int128 above = (unsigned __int128)(2 * root + 1) * (2 * root + 1);
+        mismatches += overflow || (root > 0 && below > square) || square >= above;
+    }
+    CHECK(mismatches == 0);
+
+    bool overflow = false;
+    CHECK(fixed_sqrt(4 * FIXED_SCALE, &overflow) == 2 * FIXED_SCALE);
+    CHECK(fixed_sqrt(0, &overflow) == 0);
+    CHECK_FALSE(overflow);
+
+    fixed_sqrt(-1, &overflow);
+    CHECK(overflow);
+}
+
+TEST_CASE("exponential function", "[fixed][math]")
+{
+    check_against_reference(
+        arguments(-24 * FIXED_SCALE, (fixed)(std::log((long double)FIXED_MAX / FIXED_SCALE) * FIXED_SCALE)),
+        [](fixed n) {
+            bool overflow = false;
+            fixed result = fixed_exp(n, &overflow);
+            return overflow ? -1 : result;
+        },
+        [](long double x) {
+            return std::exp(x) * FIXED_SCALE > FIXED_MAX + 0.5L ? -1.0L / FIXED_SCALE : std::exp(x);
+        });
+
+    bool overflow = false;
+    CHECK(fixed_exp(0, &overflow) == FIXED_SCALE);
+    CHECK(fixed_exp(-FIXED_MAX, &overflow) == 0);
+    CHECK_FALSE(overflow);
+
+    fixed_exp(FIXED_MAX, &overflow);
+    CHECK(overflow);
+}
+
+TEST_CASE("natural logarithm", "[fixed][math]")
+{
+    std::vector<fixed> numbers = arguments(1, 1000000);
+    for (fixed& n : numbers) {
+        n = n == INT_MIN ? 1 : std::abs(n) + (n == 0);
+    }
+    check_against_reference(
+        numbers,
+        [](fixed n) {
+            bool overflow = false;
+            return fixed_ln(n, &overflow);
+        },
+        [](long double x) { return std::log(x); });
+
+    bool overflow = false;
+    CHECK(fixed_ln(FIXED_SCALE, &overflow) == 0);
+    CHECK_FALSE(overflow);
+
+    fixed_ln(0, &overflow);
+    CHECK(overflow);
+
+    overflow = false;
+    fixed_ln(-FIXED_SCALE, &overflow);
+    CHECK(overflow);
+}
+
+TEST_CASE("sine and cosine", "[fixed][math]")
+{
+    const std::vector<fixed> numbers = arguments(-1000000, 1000000);
+    check_against_reference(numbers, fixed_sin, [](long double x) { return std::sin(x); });
+    check_against_reference(numbers, fixed_cos, [](long double x) { return std::cos(x); });
+
+    CHECK(fixed_sin(0) == 0);
+    CHECK(fixed_cos(0) == FIXED_SCALE);
+}
+
+TEST_CASE("arc tangent", "[fixed][math]")
+{
+    check_against_reference(arguments(-1000000, 1000000), fixed_atan,
+                            [](long double x) { return std::atan(x); });
+
+    CHECK(fixed_atan(0) == 0);
+}
+
+#endif
@@ -1,5 +1,6 @@
 // File: fixed_point_tests.cpp
 
+#include <cstdio>
 #include <string>
 #include <iostream>
 
@@ -7,10 +8,70 @@
 
 #include "../src/fixed.h"
 
+/* The cases written with the raw representations assume 2 decimal
+ * places, the rest hold for any FIXED_FRACTIONAL_DIGITS. */
+
+namespace {
+
+/** The text of a fixed point number. */
+std::string repr(fixed n)
+{
+    char buffer[FIXED_REPR_SIZE];
+    return fixed_repr(n, buffer, sizeof(buffer));
+}
+
+/** Parse a number expected to be in range. */
+fixed num(const char* str)
+{
+    bool overflow = false;
+    fixed n = str_to_fixed(str, &overflow);
+    REQUIRE(overflow == false);
+    return n;
+}
+
+/** The text of <tt>integral.fraction</tt> with all the decimal
+ *  places, @p fraction given in the units of the last place. */
+std::string decimal(int integral, int fraction)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%d.%0*d",
+                  integral, FIXED_FRACTIONAL_DIGITS, fraction);
+    return buffer;
+}
+
+} // namespace
+
 TEST_CASE("multiplication", "[fixed-point]")
 {
     bool overflow = false;
 
+    CHECK(fixed_mult(int_to_fixed(3), FIXED_SCALE / 2, &overflow) == 3 * FIXED_SCALE / 2);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_mult(int_to_fixed(-3), FIXED_SCALE / 2, &overflow) == -3 * FIXED_SCALE / 2);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_mult(int_to_fixed(-12), int_to_fixed(-12), &overflow) == int_to_fixed(144));
+    REQUIRE(overflow == false);
+
+    /* The products below the smallest step are truncated toward 0. */
+    CHECK(fixed_mult(1, FIXED_SCALE / 2, &overflow) == 0);
+    CHECK(fixed_mult(-1, 1, &overflow) == 0);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_mult(FIXED_MAX, int_to_fixed(1), &overflow) == FIXED_MAX);
+    CHECK(fixed_mult(FIXED_MAX, int_to_fixed(-1), &overflow) == -FIXED_MAX);
+    REQUIRE(overflow == false);
+
+    fixed_mult(FIXED_MAX, int_to_fixed(1) + 1, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    fixed_mult(int_to_fixed(-FIXED_INTEGRAL_MAX), int_to_fixed(2), &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+#if FIXED_FRACTIONAL_DIGITS == 2
     CHECK(fixed_mult(10, 20, &overflow) == 2);
     REQUIRE(overflow == false);
 
@@ -38,19 +99,130 @@ TEST_CASE("multiplication", "[fixed-point]")
     CHECK(fixed_mult(-99900, -99900, &overflow) == 99800100);
     REQUIRE(overflow == false);
 
+    CHECK(fixed_mult(150, 1431655765, &overflow) == FIXED_MAX);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_mult(-150, 1431655765, &overflow) == -FIXED_MAX);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_mult(99, 2000000000, &overflow) == 1980000000);
+    REQUIRE(overflow == false);
+
     fixed_mult(999000, 999000, &overflow);
     REQUIRE(overflow == true);
     overflow = false;
+
+    fixed_mult(200, 1431655765, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    fixed_mult(-200, 1431655765, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+#endif
+}
+
+TEST_CASE("scale division", "[fixed-point]")
+{
+    /* Compare the reciprocal multiplication against the plain
+     * division on the edge cases and a fixed pseudorandom sample. */
+    const fixed edge_cases[] = {
+        0, 1, 99, 100, 101, 199, 200, 9999, 10000, 10001,
+        FIXED_MAX - 1, FIXED_MAX, -FIXED_MAX, INT_MIN,
+    };
+    for (fixed n : edge_cases) {
+        CHECK(fixed_to_int(n) == n / FIXED_SCALE);
+    }
+
+    unsigned int seed = 12345;
+    for (int i = 0; i < 20000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        fixed lhs = (fixed)seed;
+        seed = seed * 1103515245 + 12345;
+        fixed rhs = (fixed)seed >> (i % 31);
+
+        CHECK(fixed_to_int(lhs) == lhs / FIXED_SCALE);
+
+        bool overflow = false;
+        long long expected = (long long)lhs * rhs / FIXED_SCALE;
+        fixed result = fixed_mult(lhs, rhs, &overflow);
+        if (expected > FIXED_MAX || expected < -FIXED_MAX) {
+            CHECK(overflow == true);
+        } else {
+            CHECK(overflow == false);
+            CHECK(result == expected);
+        }
+    }
 }
 
 TEST_CASE("division", "[fixed-point]")
 {
-    CHECK(fixed_div(1234, 5739) == 21);
-    CHECK(fixed_div(1234, -5739) == -21);
-    CHECK(fixed_div(-1234, 5739) == -21);
-    CHECK(fixed_div(-1234, -5739) == 21);
-    CHECK(fixed_div(1000, 50) == 2000);
-    CHECK(fixed_div(FIXED_MAX, 50) == 0);
+    bool overflow = false;
+
+    CHECK(fixed_div(int_to_fixed(15), int_to_fixed(2), &overflow) == 15 * FIXED_SCALE / 2);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_div(int_to_fixed(1), int_to_fixed(-4), &overflow) == -(FIXED_SCALE / 4));
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_div(int_to_fixed(2), int_to_fixed(3), &overflow) == 2 * FIXED_SCALE / 3);
+    REQUIRE(overflow == false);
+
+    /* The fractional part of the divisor is not dropped. */
+    CHECK(fixed_div(int_to_fixed(3), 3 * FIXED_SCALE / 2, &overflow) == int_to_fixed(2));
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_div(FIXED_MAX, int_to_fixed(1), &overflow) == FIXED_MAX);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_div(FIXED_MAX, FIXED_MAX, &overflow) == FIXED_SCALE);
+    REQUIRE(overflow == false);
+
+    fixed_div(FIXED_MAX, FIXED_SCALE / 2, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    fixed_div(int_to_fixed(12), 0, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    fixed_div(0, 0, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+#if FIXED_FRACTIONAL_DIGITS == 2
+    CHECK(fixed_div(1234, 5739, &overflow) == 21);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_div(1234, -5739, &overflow) == -21);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_div(-1234, 5739, &overflow) == -21);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_div(-1234, -5739, &overflow) == 21);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_div(1000, 50, &overflow) == 2000);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_div(FIXED_MAX, 150, &overflow) == 1431655764);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_div(-FIXED_MAX, 12345, &overflow) == -17395574);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_div(FIXED_MAX, FIXED_MAX, &overflow) == 100);
+    REQUIRE(overflow == false);
+
+    fixed_div(FIXED_MAX, 50, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    fixed_div(1234, 0, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+#endif
 }
 
 TEST_CASE("addition", "[fixed-point]")
@@ -98,6 +270,54 @@ TEST_CASE("exponent", "[fixed-point]")
 {
     bool overflow = false;
 
+    CHECK(fixed_pow(int_to_fixed(123), 0, &overflow) == FIXED_SCALE);
+    CHECK(fixed_pow(0, 0, &overflow) == FIXED_SCALE);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(int_to_fixed(2), 10, &overflow) == int_to_fixed(1024));
+    CHECK(fixed_pow(int_to_fixed(-3), 3, &overflow) == int_to_fixed(-27));
+    CHECK(fixed_pow(FIXED_SCALE / 2, 3, &overflow) == FIXED_SCALE / 8);
+    CHECK(fixed_pow(0, 5, &overflow) == 0);
+    REQUIRE(overflow == false);
+
+    /* The negative powers of the numbers below 1. */
+    CHECK(fixed_pow(FIXED_SCALE / 2, -3, &overflow) == int_to_fixed(8));
+    CHECK(fixed_pow(-FIXED_SCALE / 2, -3, &overflow) == int_to_fixed(-8));
+    CHECK(fixed_pow(FIXED_SCALE / 2, -10, &overflow) == int_to_fixed(1024));
+    CHECK(fixed_pow(FIXED_SCALE / 10, -3, &overflow) == int_to_fixed(1000));
+    CHECK(fixed_pow(FIXED_SCALE / 5, -4, &overflow) == int_to_fixed(625));
+    REQUIRE(overflow == false);
+
+    /* Truncated toward 0 like the division. */
+    CHECK(fixed_pow(int_to_fixed(10), -1, &overflow) == FIXED_SCALE / 10);
+    CHECK(fixed_pow(int_to_fixed(1000), -1, &overflow) == FIXED_SCALE / 1000);
+    CHECK(fixed_pow(int_to_fixed(3), -1, &overflow) == FIXED_SCALE / 3);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(int_to_fixed(1), INT_MIN, &overflow) == FIXED_SCALE);
+    CHECK(fixed_pow(int_to_fixed(-1), 1000001, &overflow) == -FIXED_SCALE);
+    CHECK(fixed_pow(int_to_fixed(-1), INT_MIN, &overflow) == FIXED_SCALE);
+    CHECK(fixed_pow(FIXED_SCALE / 2, 1000000, &overflow) == 0);
+    CHECK(fixed_pow(int_to_fixed(2), -1000000, &overflow) == 0);
+    REQUIRE(overflow == false);
+
+    fixed_pow(int_to_fixed(2), 31, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    fixed_pow(int_to_fixed(-2), INT_MAX, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    fixed_pow(FIXED_SCALE / 2, -31, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    fixed_pow(0, -1, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+#if FIXED_FRACTIONAL_DIGITS == 2
     CHECK(fixed_pow(12300, 0, &overflow) == 100);
     REQUIRE(overflow == false);
 
@@ -121,10 +341,93 @@ TEST_CASE("exponent", "[fixed-point]")
 
     CHECK(fixed_pow(1000, -2, &overflow) == 1);
     REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(150, 3, &overflow) == 337);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(50, -2, &overflow) == 400);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(10, -3, &overflow) == 100000);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(-10, -3, &overflow) == -100000);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(50, -20, &overflow) == 104857600);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(20, -4, &overflow) == 62500);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(30, -2, &overflow) == 1111);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(200, 24, &overflow) == 1677721600);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(-300, 13, &overflow) == -159432300);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(0, 5, &overflow) == 0);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(100, INT_MIN, &overflow) == 100);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(-100, 1000001, &overflow) == -100);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(-100, INT_MIN, &overflow) == 100);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(50, 1000000, &overflow) == 0);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(200, -1000000, &overflow) == 0);
+    REQUIRE(overflow == false);
+
+    CHECK(fixed_pow(10001, INT_MIN, &overflow) == 0);
+    REQUIRE(overflow == false);
+
+    fixed_pow(200, 1000000, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    fixed_pow(-200, INT_MAX, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    fixed_pow(200, 31, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    fixed_pow(0, -1, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    fixed_pow(50, -1000000, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+#endif
 }
 
 TEST_CASE("text representation", "[fixed-point]")
 {
+    CHECK(repr(0) == "0");
+    CHECK(repr(int_to_fixed(-1000)) == "-1000");
+    CHECK(repr(FIXED_SCALE / 2) == "0.5");
+    CHECK(repr(23 * FIXED_SCALE / 10) == "2.3");
+    CHECK(repr(-23 * FIXED_SCALE / 10) == "-2.3");
+
+    /* The smallest step. */
+    CHECK(repr(1) == decimal(0, 1));
+    CHECK(repr(-1) == "-" + decimal(0, 1));
+
+    CHECK(repr(FIXED_MAX) == decimal(FIXED_INTEGRAL_MAX, FIXED_MAX % FIXED_SCALE));
+    CHECK(repr(-FIXED_MAX) == "-" + decimal(FIXED_INTEGRAL_MAX, FIXED_MAX % FIXED_SCALE));
+
+#if FIXED_FRACTIONAL_DIGITS == 2
     char buffer[64];
     std::string repr;
 
@@ -151,12 +454,105 @@ TEST_CASE("text representation", "[fixed-point]")
 
     repr.assign(fixed_repr(-21, buffer, sizeof(buffer)));
     CHECK(repr == "-0.21");
+
+    repr.assign(fixed_repr(FIXED_MAX, buffer, sizeof(buffer)));
+    CHECK(repr == "21474836.47");
+
+    repr.assign(fixed_repr(-FIXED_MAX, buffer, sizeof(buffer)));
+    CHECK(repr == "-21474836.47");
+
+    repr.assign(fixed_repr(-100000, buffer, sizeof(buffer)));
+    CHECK(repr == "-1000");
+#endif
+}
+
+TEST_CASE("text representation length", "[fixed-point]")
+{
+    char buffer[FIXED_REPR_SIZE];
+
+    CHECK(fixed_to_str(-23 * FIXED_SCALE / 10, buffer, sizeof(buffer)) == 4);
+    CHECK(std::string(buffer) == "-2.3");
+
+    CHECK(fixed_to_str(0, buffer, sizeof(buffer)) == 1);
+    CHECK(std::string(buffer) == "0");
+
+    /* The longest one fills the whole buffer. */
+    CHECK(fixed_to_str(-FIXED_MAX, buffer, sizeof(buffer)) == FIXED_REPR_SIZE - 1);
+    CHECK(std::string(buffer) == repr(-FIXED_MAX));
+
+    /* Truncated just like with snprintf. */
+    CHECK(fixed_to_str(int_to_fixed(-1234), buffer, 4) == 3);
+    CHECK(std::string(buffer) == "-12");
+
+    CHECK(fixed_to_str(1234, buffer, 1) == 0);
+    CHECK(std::string(buffer) == "");
+
+    /* Compare with the printf-based formatting on a pseudorandom sample. */
+    unsigned int seed = 12345;
+    for (int i = 0; i < 20000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        fixed n = (fixed)seed >> (i % 31);
+        if (n == INT_MIN) {
+            continue;
+        }
+
+        char expected[FIXED_REPR_SIZE];
+        int length;
+        if (abs(n) % FIXED_SCALE == 0) {
+            length = snprintf(expected, sizeof(expected), "%s%d",
+                              n < 0 ? "-" : "", abs(n) / FIXED_SCALE);
+        } else {
+            length = snprintf(expected, sizeof(expected), "%s%d.%0*d",
+                              n < 0 ? "-" : "",
+                              abs(n) / FIXED_SCALE, FIXED_FRACTIONAL_DIGITS,
+                              abs(n) % FIXED_SCALE);
+            while (expected[length-1] == '0') {
+                expected[--length] = '\0';
+            }
+        }
+
+        CHECK(fixed_to_str(n, buffer, sizeof(buffer)) == (size_t)length);
+        CHECK(std::string(buffer) == expected);
+    }
 }
 
 TEST_CASE("conversion from string", "[fixed-point]")
 {
     bool overflow = false;
 
+    CHECK(str_to_fixed("123", &overflow) == int_to_fixed(123));
+    CHECK(str_to_fixed("9.00", &overflow) == int_to_fixed(9));
+    CHECK(str_to_fixed("0.5", &overflow) == FIXED_SCALE / 2);
+    CHECK(str_to_fixed("-7.5", &overflow) == -75 * FIXED_SCALE / 10);
+    REQUIRE(overflow == false);
+
+    /* The digits beyond the precision are ignored. */
+    CHECK(str_to_fixed("1.99999", &overflow) == 2 * FIXED_SCALE - 1);
+    CHECK(str_to_fixed("-1.99999", &overflow) == -(2 * FIXED_SCALE - 1));
+    REQUIRE(overflow == false);
+
+    const int max_fraction = FIXED_MAX % FIXED_SCALE;
+    CHECK(str_to_fixed(decimal(FIXED_INTEGRAL_MAX, max_fraction).c_str(), &overflow) == FIXED_MAX);
+    CHECK(str_to_fixed(("-" + decimal(FIXED_INTEGRAL_MAX, max_fraction)).c_str(), &overflow) == -FIXED_MAX);
+    REQUIRE(overflow == false);
+
+    str_to_fixed(decimal(FIXED_INTEGRAL_MAX, max_fraction + 1).c_str(), &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    str_to_fixed(("-" + decimal(FIXED_INTEGRAL_MAX, max_fraction + 1)).c_str(), &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    str_to_fixed(std::to_string(FIXED_INTEGRAL_MAX + 1).c_str(), &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    str_to_fixed("99999999999999999999", &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+#if FIXED_FRACTIONAL_DIGITS == 2
     CHECK(str_to_fixed("123.45", &overflow) == 12345);
     REQUIRE(overflow == false);
 
@@ -200,4 +596,110 @@ TEST_CASE("conversion from string", "[fixed-point]")
     str_to_fixed("21474837.48", &overflow);
     REQUIRE(overflow == true);
     overflow = false;
+
+    str_to_fixed("21474836.48", &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    str_to_fixed("-21474836.48", &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+#endif
+}
+
+TEST_CASE("conversion from a part of string", "[fixed-point]")
+{
+    bool overflow = false;
+    char* endptr;
+
+    const char* numbers = "12.345 -6.7\n8";
+
+    CHECK(strn_to_fixed(numbers, 14, &endptr, &overflow) == num("12.345"));
+    REQUIRE(overflow == false);
+    CHECK(endptr == numbers + 6);
+
+    CHECK(strn_to_fixed(numbers + 7, 7, &endptr, &overflow) == num("-6.7"));
+    REQUIRE(overflow == false);
+    CHECK(endptr == numbers + 11);
+
+    CHECK(strn_to_fixed(numbers, 4, &endptr, &overflow) == num("12.3"));
+    REQUIRE(overflow == false);
+    CHECK(endptr == numbers + 4);
+
+    CHECK(strn_to_fixed(numbers, 2, &endptr, &overflow) == num("12"));
+    REQUIRE(overflow == false);
+    CHECK(endptr == numbers + 2);
+
+    CHECK(strn_to_fixed(numbers, 0, &endptr, &overflow) == 0);
+    REQUIRE(overflow == false);
+    CHECK(endptr == numbers);
+
+    CHECK(strn_to_fixed("-", 1, &endptr, &overflow) == 0);
+    REQUIRE(overflow == false);
+
+    CHECK(strn_to_fixed("5.", 2, NULL, &overflow) == num("5"));
+    REQUIRE(overflow == false);
+}
+
+TEST_CASE("digit accumulation", "[fixed-point]")
+{
+    bool overflow = false;
+    fixed n = 0;
+
+    /* Type "123.456" digit by digit, the digits beyond the precision
+     * are ignored... */
+    n = fixed_append_digit(n, 1, -1, &overflow);
+    n = fixed_append_digit(n, 2, -1, &overflow);
+    n = fixed_append_digit(n, 3, -1, &overflow);
+    CHECK(n == num("123"));
+    n = fixed_append_digit(n, 4, 0, &overflow);
+    CHECK(n == num("123.4"));
+    n = fixed_append_digit(n, 5, 1, &overflow);
+    CHECK(n == num("123.45"));
+    n = fixed_append_digit(n, 6, 2, &overflow);
+    CHECK(n == num("123.456"));
+    REQUIRE(overflow == false);
+
+    /* ...and delete it back. */
+    n = fixed_remove_digit(n, 6, 2);
+    CHECK(n == num("123.45"));
+    n = fixed_remove_digit(n, 5, 1);
+    CHECK(n == num("123.4"));
+    n = fixed_remove_digit(n, 4, 0);
+    CHECK(n == num("123"));
+    n = fixed_remove_digit(n, 3, -1);
+    CHECK(n == num("12"));
+    n = fixed_remove_digit(n, 2, -1);
+    n = fixed_remove_digit(n, 1, -1);
+    CHECK(n == 0);
+
+    /* Type the largest number. */
+    const std::string max = repr(FIXED_MAX);
+    int fractional_digits = -1;
+    n = 0;
+    for (char c : max) {
+        if (c == '.') {
+            fractional_digits = 0;
+        } else {
+            n = fixed_append_digit(n, c - '0', fractional_digits, &overflow);
+            fractional_digits += fractional_digits >= 0;
+        }
+    }
+    CHECK(n == FIXED_MAX);
+    REQUIRE(overflow == false);
+
+    fixed_append_digit(int_to_fixed(FIXED_INTEGRAL_MAX / 10 + 1), 0, -1, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+    fixed_append_digit(FIXED_MAX - FIXED_MAX % 10, FIXED_MAX % 10 + 1,
+                       FIXED_FRACTIONAL_DIGITS - 1, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+
+#if FIXED_FRACTIONAL_DIGITS == 2
+    fixed_append_digit(2147483600, 7, -1, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+#endif
 }
@@ -0,0 +1,57 @@
+// File: fixed_scale_tests.cpp
+
+#include "catch.hpp"
+
+#include "../src/fixed.h"
+#include "../src/fixed_scale.hpp"
+
+typedef fixed_scale<FIXED_FRACTIONAL_DIGITS> configured_scale;
+
+/* The pregenerated constants of the C build need to match the derived ones. */
+static_assert(configured_scale::scale == FIXED_SCALE, "FIXED_SCALE");
+static_assert(configured_scale::integral_max == FIXED_INTEGRAL_MAX, "FIXED_INTEGRAL_MAX");
+static_assert(configured_scale::integral_digits == FIXED_INTEGRAL_DIGITS, "FIXED_INTEGRAL_DIGITS");
+static_assert(configured_scale::repr_size == FIXED_REPR_SIZE, "FIXED_REPR_SIZE");
+static_assert(configured_scale::div64_magic == FIXED_DIV64_MAGIC, "FIXED_DIV64_MAGIC");
+static_assert(configured_scale::div64_shift == FIXED_DIV64_SHIFT, "FIXED_DIV64_SHIFT");
+
+template <int Digits>
+static void check_scale_division()
+{
+    typedef fixed_scale<Digits> scale;
+
+    const uint64_t edges64[] = {
+        0, 1, scale::scale - 1, scale::scale, scale::scale + 1, UINT32_MAX, (uint64_t)INT_MAX * INT_MAX, INT64_MAX - 1, INT64_MAX,
+    };
+    for (uint64_t n : edges64) {
+        CHECK(scale::div(n) == n / scale::scale);
+    }
+
+    uint64_t seed = 88172645463325252ULL;
+    for (int i = 0; i < 10000; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        uint64_t n64 = (seed >> 1) >> (i % 63);
+        CHECK(scale::div(n64) == n64 / scale::scale);
+    }
+}
+
+TEST_CASE("compile-time scale constants", "[fixed-scale]")
+{
+    CHECK(fixed_scale<1>::integral_max == 214748364);
+    CHECK(fixed_scale<2>::integral_max == 21474836);
+    CHECK(fixed_scale<4>::integral_max == 214748);
+
+    CHECK(fixed_scale<1>::repr_size == 13);
+    CHECK(fixed_scale<2>::repr_size == 13);
+    CHECK(fixed_scale<4>::repr_size == 13);
+
+    CHECK(fixed_scale<2>::div64_magic == 0xA3D70A3D70A3D70BULL);
+    CHECK(fixed_scale<2>::div64_shift == 6);
+
+    check_scale_division<1>();
+    check_scale_division<2>();
+    check_scale_division<3>();
+    check_scale_division<4>();
+}
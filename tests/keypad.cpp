@@ -0,0 +1 @@
+../src/keypad.c
\ No newline at end of file
@@ -0,0 +1,43 @@
+// File: keypad_tests.cpp
+
+#include "catch.hpp"
+
+#include "../src/keypad.h"
+
+TEST_CASE("keypad layout", "[keypad]")
+{
+    const int columns[KEYPAD_COLUMNS] = {5, 40, 75, 110};
+    for (int key = 0; key < KEY_COUNT; ++key) {
+        const KeypadRect* rect = keypad_key_rect(key);
+        INFO("key: " << key);
+        CHECK(rect->x == columns[key % KEYPAD_COLUMNS]);
+        CHECK(rect->y == 4 + key / KEYPAD_COLUMNS * 30);
+        CHECK(rect->w == 30);
+        CHECK(rect->h == 25);
+    }
+}
+
+TEST_CASE("keypad hit-testing", "[keypad]")
+{
+    /* The same as checking every key like grect_contains_point does. */
+    int mismatches = 0;
+    for (int y = -10; y < 140; ++y) {
+        for (int x = -10; x < KEYPAD_WIDTH + 10; ++x) {
+            int expected = -1;
+            for (int key = 0; key < KEY_COUNT; ++key) {
+                const KeypadRect* rect = keypad_key_rect(key);
+                if (x >= rect->x && x < rect->x + rect->w
+                    && y >= rect->y && y < rect->y + rect->h) {
+                    expected = key;
+                }
+            }
+            mismatches += keypad_key_at(x, y) != expected;
+        }
+    }
+    CHECK(mismatches == 0);
+
+    CHECK(keypad_key_at(5, 4) == 0);
+    CHECK(keypad_key_at(35, 4) == -1);
+    CHECK(keypad_key_at(40, 4) == 1);
+    CHECK(keypad_key_at(139, 118) == 15);
+}
@@ -0,0 +1 @@
+../src/operation.c
\ No newline at end of file
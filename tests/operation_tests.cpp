@@ -0,0 +1,55 @@
+// File: operation_tests.cpp
+
+#include "catch.hpp"
+
+#include "../src/operation.h"
+
+namespace {
+
+/** Parse a number of the calculator type. */
+CALC_TYPE num(const char* str)
+{
+    bool overflow = false;
+    CALC_TYPE n = CREATE_OPERATOR_FOR_TYPE(str_to, CALC_TYPE)(str, &overflow);
+    REQUIRE(overflow == false);
+    return n;
+}
+
+} // namespace
+
+TEST_CASE("operations", "[operation]")
+{
+    CALC_TYPE result = 0;
+
+    CHECK(operation_perform('+', num("1.5"), num("2"), &result) == OPERATION_OK);
+    CHECK(result == num("3.5"));
+
+    CHECK(operation_perform('/', num("7.5"), num("2.5"), &result) == OPERATION_OK);
+    CHECK(result == num("3"));
+
+    CHECK(operation_perform('^', num("2"), num("10.9"), &result) == OPERATION_OK);
+    CHECK(result == num("1024"));
+}
+
+TEST_CASE("operation errors", "[operation]")
+{
+    CALC_TYPE result = num("42");
+
+    /* In range, not an overflow. */
+    CHECK(operation_perform('^', num("0.5"), num("-3"), &result) == OPERATION_OK);
+    CHECK(result == num("8"));
+    CHECK(operation_perform('^', num("0.5"), num("-10"), &result) == OPERATION_OK);
+    CHECK(result == num("1024"));
+#if ENABLE_FIXED64 || !ENABLE_QFIXED
+    /* The tenths are exact only in the decimal types. */
+    CHECK(operation_perform('^', num("0.1"), num("-3"), &result) == OPERATION_OK);
+    CHECK(result == num("1000"));
+#endif
+
+    result = num("42");
+    CHECK(operation_perform('/', num("1"), num("0"), &result) == OPERATION_DIVISION_BY_ZERO);
+    CHECK(operation_perform('^', num("0"), num("-2"), &result) == OPERATION_DIVISION_BY_ZERO);
+    CHECK(operation_perform('^', num("2"), num("1000"), &result) == OPERATION_OVERFLOW);
+    CHECK(operation_perform('^', num("0.5"), num("-1000"), &result) == OPERATION_OVERFLOW);
+    CHECK(result == num("42"));
+}
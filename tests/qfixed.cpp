@@ -0,0 +1 @@
+../src/qfixed.c
\ No newline at end of file
@@ -0,0 +1,145 @@
+// File: qfixed_tests.cpp
+
+#include <cstdio>
+#include <string>
+
+#include "catch.hpp"
+
+#include "../src/qfixed.h"
+
+namespace {
+
+std::string repr(qfixed n)
+{
+    char buffer[QFIXED_REPR_SIZE];
+    return qfixed_repr(n, buffer, sizeof(buffer));
+}
+
+qfixed parse(const char* str)
+{
+    bool overflow = false;
+    qfixed n = str_to_qfixed(str, &overflow);
+    REQUIRE(overflow == false);
+    return n;
+}
+
+qfixed parse(const std::string& str)
+{
+    return parse(str.c_str());
+}
+
+/** The decimal text of <tt>integral + tenths / 10</tt> binary steps
+ *  (units of 2^-QFIXED_FRACTIONAL_BITS), with more fractional digits
+ *  than shown. */
+std::string steps(int integral, long long tenths)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%d.%09lld",
+                  integral, tenths * 100000000 / QFIXED_ONE);
+    return buffer;
+}
+
+/** The text of @p numerator / 3 rounded to the shown decimal places. */
+std::string thirds(int numerator)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "0.%0*d", QFIXED_FRACTIONAL_DIGITS,
+                  (numerator * QFIXED_DECIMAL_SCALE + 1) / 3);
+    return buffer;
+}
+
+} // namespace
+
+TEST_CASE("binary multiplication", "[qfixed]")
+{
+    bool overflow = false;
+
+    CHECK(qfixed_mult(3 * QFIXED_ONE, QFIXED_ONE / 2, &overflow) == 3 * QFIXED_ONE / 2);
+    REQUIRE(overflow == false);
+
+    /* Rounded to the nearest, away from 0 on ties. */
+    CHECK(qfixed_mult(3, QFIXED_ONE / 2, &overflow) == 2);
+    CHECK(qfixed_mult(-3, QFIXED_ONE / 2, &overflow) == -2);
+    CHECK(qfixed_mult(1, QFIXED_ONE / 4, &overflow) == 0);
+    REQUIRE(overflow == false);
+
+    CHECK(qfixed_mult(QFIXED_MAX, QFIXED_ONE, &overflow) == QFIXED_MAX);
+    REQUIRE(overflow == false);
+
+    qfixed_mult(QFIXED_MAX, QFIXED_ONE + 1, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+}
+
+TEST_CASE("binary division", "[qfixed]")
+{
+    bool overflow = false;
+
+    CHECK(qfixed_div(QFIXED_ONE, 3 * QFIXED_ONE, &overflow) == (QFIXED_ONE + 1) / 3);
+    CHECK(qfixed_div(2 * QFIXED_ONE, -3 * QFIXED_ONE, &overflow) == -(2 * QFIXED_ONE + 1) / 3);
+    REQUIRE(overflow == false);
+
+    CHECK(qfixed_div(QFIXED_MAX, QFIXED_ONE, &overflow) == QFIXED_MAX);
+    REQUIRE(overflow == false);
+
+    qfixed_div(QFIXED_MAX, QFIXED_ONE - 1, &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+}
+
+TEST_CASE("binary text representation", "[qfixed]")
+{
+    /* The binary approximations are shown as the decimal numbers
+     * they approximate. */
+    CHECK(repr(parse("0.1")) == "0.1");
+    CHECK(repr(parse("-0.3")) == "-0.3");
+    CHECK(repr(parse("123.456")) == "123.456");
+
+    bool overflow = false;
+    CHECK(repr(qfixed_div(QFIXED_ONE, 3 * QFIXED_ONE, &overflow)) == thirds(1));
+    CHECK(repr(qfixed_div(2 * QFIXED_ONE, 3 * QFIXED_ONE, &overflow)) == thirds(2));
+    REQUIRE(overflow == false);
+
+    /* No negative zero. */
+    CHECK(repr(-1) == "0");
+
+    /* Rounded down at the end of the range, to be parsed back. */
+    const std::string max = std::to_string(QFIXED_INTEGRAL_MAX) + "."
+        + std::string(QFIXED_FRACTIONAL_DIGITS, '9');
+    CHECK(repr(QFIXED_MAX) == max);
+    CHECK(repr(-QFIXED_MAX) == "-" + max);
+
+    /* The parser rounds to the nearest too. */
+    CHECK(parse(steps(0, 6)) == 1);
+    CHECK(parse("-" + steps(0, 4)) == 0);
+    CHECK(parse(steps(QFIXED_INTEGRAL_MAX, (QFIXED_ONE - 1) * 10LL + 4)) == QFIXED_MAX);
+
+    str_to_qfixed(steps(QFIXED_INTEGRAL_MAX, (QFIXED_ONE - 1) * 10LL + 6).c_str(), &overflow);
+    REQUIRE(overflow == true);
+    overflow = false;
+}
+
+TEST_CASE("binary digit accumulation", "[qfixed]")
+{
+    /* Every number typed digit by digit equals the parsed one. */
+    char text[16];
+    const int scale = QFIXED_DECIMAL_SCALE;
+    for (int i = 0; i < 10 * scale; i += 7) {
+        bool overflow = false;
+        qfixed n = 0;
+        n = qfixed_append_digit(n, i / scale, -1, &overflow);
+        for (int place = scale / 10, digits = 0; place > 0; place /= 10, ++digits) {
+            n = qfixed_append_digit(n, i / place % 10, digits, &overflow);
+        }
+        REQUIRE(overflow == false);
+
+        std::snprintf(text, sizeof(text), "%d.%0*d",
+                      i / scale, QFIXED_FRACTIONAL_DIGITS, i % scale);
+        REQUIRE(n == parse(text));
+
+        n = qfixed_remove_digit(n, i % 10, QFIXED_FRACTIONAL_DIGITS - 1);
+        std::snprintf(text, sizeof(text), "%d.%0*d",
+                      i / scale, QFIXED_FRACTIONAL_DIGITS - 1, i % scale / 10);
+        REQUIRE(n == parse(text));
+    }
+}